@@ -0,0 +1,76 @@
+#include <beard/fmt/fmt.h>
+#include <beard/io/async_reader.h>
+#include <beard/io/io.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Usage: BenchAsyncRead [file_count]
+// The files are in the page cache after being written, so this measures the
+// cost of the syscalls rather than the disk
+int main(int argc, char** argv) {
+  i32 file_count = 20000;
+  if (argc > 1) {
+    file_count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  namespace fs = std::filesystem;
+  fs::path directory = "bench_async_read";
+  fs::create_directories(directory);
+
+  std::vector<std::string> paths;
+  std::vector<usize> sizes;
+  for (i32 i = 0; i < file_count; ++i) {
+    paths.push_back((directory / fmt::format("asset_{}.bin", i)).string());
+    sizes.push_back(512 + (i * 7919) % 8192);
+    beard::io::write_whole_file(paths.back(), std::string(sizes.back(), 'x'));
+  }
+  fmt::print("{} files\n", file_count);
+
+  beard::timer timer;
+  usize total = 0;
+  for (const auto& path : paths) {
+    total += beard::io::read_whole_file(path).size();
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:8.0f} files/s [{}]\n", "read_whole_file",
+             file_count / timer.delta_time(), total);
+
+  std::vector<std::vector<char>> buffers(paths.size());
+  for (usize i = 0; i < paths.size(); ++i) {
+    buffers[i].resize(sizes[i]);
+  }
+
+  beard::io::async_reader reader;
+  std::atomic<usize> async_total = 0;
+  timer.tick();
+  for (usize i = 0; i < paths.size(); ++i) {
+    reader.read(paths[i], buffers[i], [&](const beard::io::read_result& r) {
+      async_total.fetch_add(r.size, std::memory_order_relaxed);
+    });
+  }
+  reader.wait();
+  timer.tick();
+  fmt::print("  {:<32} {:8.0f} files/s [{}]\n",
+             reader.is_using_io_uring() ? "async_reader (io_uring)"
+                                        : "async_reader (thread pool)",
+             file_count / timer.delta_time(), async_total.load());
+
+  std::vector<std::string_view> path_views(paths.begin(), paths.end());
+  timer.tick();
+  auto batch = beard::io::read_many_files(path_views, reader);
+  timer.tick();
+  total = 0;
+  for (i32 i = 0; i < batch.file_count(); ++i) {
+    total += batch[i].size();
+  }
+  fmt::print("  {:<32} {:8.0f} files/s [{}]\n", "read_many_files",
+             file_count / timer.delta_time(), total);
+
+  fs::remove_all(directory);
+  return 0;
+}
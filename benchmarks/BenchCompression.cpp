@@ -0,0 +1,116 @@
+#include <beard/containers/array.h>
+#include <beard/fmt/fmt.h>
+#include <beard/io/compressed_file.h>
+#include <beard/io/compression.h>
+#include <beard/io/io.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+// Usage: BenchCompression [size_in_mb]
+// Compresses CSV like records, then streams them back from a file in the
+// page cache
+int main(int argc, char** argv) {
+  usize size = MB(usize{128});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  std::string data;
+  data.reserve(size + 256);
+  for (u32 i = 0; data.size() < size; ++i) {
+    u32 random = i * 2654435761u;
+    data += fmt::format("{},2024-01-{:02}T{:02}:{:02}:00,{:.2f},{}\n", i,
+                        1 + random % 28, random % 24, (random >> 8) % 60,
+                        (random >> 16) % 10000 * 0.37,
+                        random % 5 == 0 ? "error" : "ok");
+  }
+  fmt::print("{} MB\n", data.size() >> 20);
+
+  beard::timer timer;
+  auto report = [&](std::string_view name, usize processed, usize output) {
+    timer.tick();
+    fmt::print("  {:<32} {:6.0f} MB/s  ratio {:.2f}\n", name,
+               processed / timer.delta_time() * 1e-6,
+               static_cast<f64>(data.size()) / output);
+  };
+
+  timer.tick();
+  std::string compressed = beard::io::compress(data);
+  report("compress (fast)", data.size(), compressed.size());
+
+  std::string compressed_high =
+      beard::io::compress(data, beard::io::compression_level::high);
+  report("compress (high)", data.size(), compressed_high.size());
+
+  auto decompressed = beard::io::decompress(compressed);
+  report("decompress (fast)", data.size(), compressed.size());
+  if (!decompressed.has_value() || decompressed.value() != data) {
+    fmt::print("Round trip failed\n");
+    return 1;
+  }
+
+  decompressed = beard::io::decompress(compressed_high);
+  report("decompress (high)", data.size(), compressed_high.size());
+
+  // The codec alone, decompressing blocks into a buffer that stays in cache
+  constexpr usize BLOCK_SIZE = beard::io::compression_frame::DEFAULT_BLOCK_SIZE;
+  beard::io::block_compressor compressor;
+  beard::array<std::string> blocks;
+  for (usize i = 0; i < data.size(); i += BLOCK_SIZE) {
+    std::string_view input = std::string_view{data}.substr(i, BLOCK_SIZE);
+    blocks.add(std::string(beard::io::compress_bound(input.size()), '\0'));
+    std::string& block = blocks.last();
+    block.resize(compressor.compress(input, block));
+  }
+  std::string block_output(BLOCK_SIZE, '\0');
+  usize block_total = 0;
+  usize block_compressed_size = 0;
+  timer.tick();
+  for (const std::string& block : blocks) {
+    auto size = beard::io::decompress_block(block, block_output);
+    block_total += size.has_value() ? size.value() : 0;
+    block_compressed_size += block.size();
+  }
+  report("decompress blocks (fast)", block_total, block_compressed_size);
+
+  const char* plain_filename = "bench_compression.csv";
+  const char* filename = "bench_compression.csv.lz";
+  beard::io::write_whole_file(plain_filename, data);
+  {
+    beard::io::compressed_file_writer writer;
+    writer.open(filename);
+    for (usize i = 0; i < data.size(); i += KB(usize{16})) {
+      writer.write(std::string_view{data}.substr(i, KB(usize{16})));
+    }
+    writer.close();
+  }
+  timer.tick();
+
+  auto count_lines = [&](auto& reader, std::string_view name) {
+    timer.tick();
+    reader.open(name == "file_stream_reader" ? plain_filename : filename);
+    usize total = 0;
+    i64 line_count = 0;
+    for (auto chunk = reader.next_chunk(); !chunk.empty();
+         chunk = reader.next_chunk()) {
+      line_count += std::count(chunk.begin(), chunk.end(), '\n');
+      total += chunk.size();
+    }
+    timer.tick();
+    fmt::print("  {:<32} {:6.0f} MB/s [{}]\n", name,
+               total / timer.delta_time() * 1e-6, line_count);
+  };
+
+  beard::io::file_stream_reader plain_reader;
+  count_lines(plain_reader, "file_stream_reader");
+  beard::io::compressed_file_reader compressed_reader;
+  count_lines(compressed_reader, "compressed_file_reader");
+
+  std::remove(plain_filename);
+  std::remove(filename);
+  return 0;
+}
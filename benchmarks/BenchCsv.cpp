@@ -0,0 +1,70 @@
+#include <beard/fmt/csv.h>
+#include <beard/fmt/fmt.h>
+#include <beard/io/io.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+// Usage: BenchCsv [size_in_mb]
+int main(int argc, char** argv) {
+  usize size = MB(usize{256});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  // id, name (sometimes quoted), price, quantity, comment (sometimes with
+  // escaped quotes)
+  std::mt19937_64 rng{42};
+  std::string text = "id,name,price,quantity,comment\n";
+  text.reserve(size + 256);
+  for (u64 id = 0; text.size() < size; ++id) {
+    text += std::to_string(id);
+    text += rng() % 8 == 0 ? ",\"Doe, John\"," : ",product,";
+    text += std::to_string(rng() % 100000 / 100.0);
+    text += ',';
+    text += std::to_string(rng() % 1000);
+    text += rng() % 16 == 0 ? ",\"said \"\"hi\"\"\"\n" : ",nothing to say\n";
+  }
+
+  const char* filename = "bench_csv.csv";
+  beard::io::write_whole_file(filename, text);
+  fmt::print("{} MB of csv\n", text.size() >> 20);
+
+  beard::timer timer;
+  f64 total = 0;
+  for (auto line : beard::fmt::split_lines(text)) {
+    auto fields = beard::fmt::tokenize(line, ",", false);
+    total += beard::fmt::parse_number<f64>(fields[2]).value();
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.0f} MB/s [{:.0f}]\n",
+             "split_lines + tokenize (memory)",
+             text.size() / timer.delta_time() * 1e-6, total);
+
+  for (bool from_memory : {true, false}) {
+    total = 0;
+    timer.tick();
+    beard::fmt::csv_reader reader;
+    if (from_memory) {
+      reader.open_from_memory(text);
+    } else {
+      reader.open(filename);
+    }
+    reader.read_header();
+    i32 price = reader.column_index("price");
+    beard::fmt::csv_row row;
+    while (reader.next_row(row)) {
+      total += row.get<f64>(price).value();
+    }
+    timer.tick();
+    fmt::print("  {:<32} {:6.0f} MB/s [{:.0f}]\n",
+               from_memory ? "csv_reader (memory)" : "csv_reader (file)",
+               text.size() / timer.delta_time() * 1e-6, total);
+  }
+
+  std::remove(filename);
+  return 0;
+}
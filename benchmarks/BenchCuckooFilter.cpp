@@ -0,0 +1,107 @@
+#include <beard/containers/array.h>
+#include <beard/containers/cuckoo_filter.h>
+#include <beard/containers/hash_set.h>
+#include <beard/fmt/fmt.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// Count heap usage so that the memory of hash_set nodes is accounted for
+global_variable usize g_allocated_bytes = 0;
+
+void* operator new(usize size) {
+  g_allocated_bytes += size;
+  if (void* p = malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, usize size) noexcept {
+  g_allocated_bytes -= size;
+  free(p);
+}
+
+template <typename Fn>
+void measure(const char* name, i32 count, Fn&& fn) {
+  beard::timer timer;
+  fn();
+  timer.tick();
+  fmt::print("  {:<10} {:7.2f} Mops/s\n", name,
+             count / timer.delta_time() * 1e-6);
+}
+
+// Usage: BenchCuckooFilter [key_count]
+int main(int argc, char** argv) {
+  i32 count = 10'000'000;
+  if (argc > 1) {
+    count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  beard::array<std::string> keys;
+  beard::array<std::string> missing_keys;
+  keys.reserve(count);
+  missing_keys.reserve(count);
+  for (i32 i = 0; i < count; ++i) {
+    keys.add("key_" + std::to_string(i));
+    missing_keys.add("missing_" + std::to_string(i));
+  }
+
+  {
+    fmt::print("cuckoo_filter (1% target false positive rate)\n");
+    usize before = g_allocated_bytes;
+    beard::cuckoo_filter filter{static_cast<u64>(count), 0.01};
+    i32 false_positives = 0;
+    measure("add", count, [&] {
+      for (auto& key : keys) {
+        filter.add(key);
+      }
+    });
+    usize memory = g_allocated_bytes - before;
+    measure("contains", count, [&] {
+      for (auto& key : missing_keys) {
+        false_positives += filter.contains(key);
+      }
+    });
+    measure("remove", count, [&] {
+      for (auto& key : keys) {
+        filter.remove(key);
+      }
+    });
+    fmt::print("  memory: {:.1f} MB ({:.1f} bits/key), false positives: "
+               "{:.3f}%\n",
+               memory / 1e6, memory * 8.0 / count,
+               100.0 * false_positives / count);
+  }
+
+  {
+    fmt::print("hash_set<std::string>\n");
+    usize before = g_allocated_bytes;
+    beard::hash_set<std::string> set;
+    i32 found = 0;
+    measure("add", count, [&] {
+      for (auto& key : keys) {
+        set.add(key);
+      }
+    });
+    usize memory = g_allocated_bytes - before;
+    measure("contains", count, [&] {
+      for (auto& key : missing_keys) {
+        found += set.contains(key);
+      }
+    });
+    measure("remove", count, [&] {
+      for (auto& key : keys) {
+        set.remove(key);
+      }
+    });
+    fmt::print("  memory: {:.1f} MB ({:.1f} bytes/key) [{}]\n", memory / 1e6,
+               static_cast<f64>(memory) / count, found);
+  }
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <beard/fmt/fmt.h>
+#include <beard/io/directory_scanner.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+// Usage: BenchDirectoryScan [file_count]
+// Walks a tree of empty files, 100 per directory and 100 directories per
+// parent, which stays in the dentry cache after being created
+int main(int argc, char** argv) {
+  i32 file_count = 500'000;
+  if (argc > 1) {
+    file_count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  namespace fs = std::filesystem;
+  fs::path root = "bench_directory_scan";
+  for (i32 i = 0; i < file_count; ++i) {
+    fs::path directory = root / fmt::format("group_{}", i / 10000) /
+                         fmt::format("dir_{}", i / 100);
+    if (i % 100 == 0) {
+      fs::create_directories(directory);
+    }
+    const char* extension = i % 4 == 0 ? "png" : "json";
+    std::string path =
+        (directory / fmt::format("asset_{}.{}", i, extension)).string();
+    fclose(fopen(path.c_str(), "wb"));
+  }
+  fmt::print("{} files\n", file_count);
+
+  beard::timer timer;
+  auto report = [&](std::string_view name, usize found) {
+    timer.tick();
+    fmt::print("  {:<36} {:8.3f}s {:6.2f} M files/s [{}]\n", name,
+               timer.delta_time(), file_count / timer.delta_time() * 1e-6,
+               found);
+  };
+
+  timer.tick();
+  usize found = 0;
+  u64 size = 0;
+  for (const auto& entry : fs::recursive_directory_iterator{root}) {
+    if (entry.is_regular_file()) {
+      size += entry.file_size();
+      ++found;
+    }
+  }
+  report("recursive_directory_iterator", found);
+
+  auto listing = beard::io::scan_directory(root.string());
+  report("scan_directory", listing.entry_count());
+
+  beard::io::scan_options options;
+  options.stat_files = false;
+  listing = beard::io::scan_directory(root.string(), options);
+  report("scan_directory (no stat)", listing.entry_count());
+
+  options.extensions = {"png"};
+  listing = beard::io::scan_directory(root.string(), options);
+  report("scan_directory (png, no stat)", listing.entry_count());
+
+  beard::thread_pool single_thread{1};
+  listing = beard::io::scan_directory(root.string(), {}, single_thread);
+  report("scan_directory (1 worker thread)", listing.entry_count());
+
+  fs::remove_all(root);
+  return 0;
+}
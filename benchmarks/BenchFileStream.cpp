@@ -0,0 +1,64 @@
+#include <beard/fmt/fmt.h>
+#include <beard/io/file_stream_reader.h>
+#include <beard/io/io.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+// Usage: BenchFileStream [size_in_mb]
+// Counts the lines of a file, the file is in the page cache after being
+// written so this measures the overlap of reading and processing
+int main(int argc, char** argv) {
+  usize size = MB(usize{512});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  const char* filename = "bench_file_stream.txt";
+  {
+    std::string line = "a line of text, about as long as a log line\n";
+    std::string text;
+    text.reserve(MB(usize{16}));
+    FILE* file = fopen(filename, "wb");
+    for (usize written = 0; written < size; written += text.size()) {
+      text.clear();
+      while (text.size() + line.size() <= MB(usize{16})) {
+        text += line;
+      }
+      fwrite(text.data(), 1, text.size(), file);
+    }
+    fclose(file);
+  }
+
+  beard::timer timer;
+  std::string content = beard::io::read_whole_file(filename);
+  auto line_count = std::count(content.begin(), content.end(), '\n');
+  timer.tick();
+  fmt::print("{} MB\n", content.size() >> 20);
+  fmt::print("  {:<32} {:6.0f} MB/s [{}]\n", "read_whole_file",
+             content.size() / timer.delta_time() * 1e-6, line_count);
+  content = {};
+
+  for (usize chunk_size : {MB(usize{1}), MB(usize{4}), MB(usize{16})}) {
+    timer.tick();
+    beard::io::file_stream_reader reader{chunk_size};
+    reader.open(filename);
+    usize total = 0;
+    line_count = 0;
+    for (auto chunk = reader.next_chunk(); !chunk.empty();
+         chunk = reader.next_chunk()) {
+      line_count += std::count(chunk.begin(), chunk.end(), '\n');
+      total += chunk.size();
+    }
+    timer.tick();
+    fmt::print("  {:<32} {:6.0f} MB/s [{}]\n",
+               fmt::format("file_stream_reader ({} MB)", chunk_size >> 20),
+               total / timer.delta_time() * 1e-6, line_count);
+  }
+
+  std::remove(filename);
+  return 0;
+}
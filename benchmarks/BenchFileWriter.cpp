@@ -0,0 +1,95 @@
+#include <beard/fmt/fmt.h>
+#include <beard/io/buffered_file_writer.h>
+#include <beard/io/io.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if !BEARD_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Usage: BenchFileWriter [record_count]
+// Appends small records (~40 bytes) to a file
+int main(int argc, char** argv) {
+  i32 record_count = 10'000'000;
+  if (argc > 1) {
+    record_count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  std::vector<std::string> records;
+  for (i32 i = 0; i < 1024; ++i) {
+    records.push_back(fmt::format("{},2024-01-01T00:00:{:02},{:.2f},ok\n",
+                                  i * 7919, i % 60, i * 0.37));
+  }
+
+  const char* filename = "bench_file_writer.txt";
+  beard::timer timer;
+  auto report = [&](std::string_view name, i32 count, u64 size) {
+    timer.tick();
+    fmt::print("  {:<32} {:6.1f} M records/s {:6.0f} MB/s\n", name,
+               count / timer.delta_time() * 1e-6,
+               size / timer.delta_time() * 1e-6);
+  };
+
+  u64 size = 0;
+  timer.tick();
+  FILE* file = fopen(filename, "wb");
+  for (i32 i = 0; i < record_count; ++i) {
+    const auto& record = records[i & 1023];
+    size += fwrite(record.data(), 1, record.size(), file);
+  }
+  fclose(file);
+  report("fwrite per record", record_count, size);
+
+#if !BEARD_PLATFORM_WINDOWS
+  // Much slower, on fewer records
+  i32 syscall_count = record_count / 20;
+  size = 0;
+  timer.tick();
+  int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  for (i32 i = 0; i < syscall_count; ++i) {
+    const auto& record = records[i & 1023];
+    size += static_cast<u64>(write(fd, record.data(), record.size()));
+  }
+  close(fd);
+  report("write per record", syscall_count, size);
+#endif
+
+  for (bool use_direct_io : {false, true}) {
+    timer.tick();
+    beard::io::buffered_file_writer writer;
+    writer.open(filename, beard::io::write_mode::truncate, use_direct_io);
+    for (i32 i = 0; i < record_count; ++i) {
+      writer.write(records[i & 1023]);
+    }
+    size = writer.size();
+    bool is_direct = writer.is_using_direct_io();
+    writer.close();
+    report(is_direct ? "buffered_file_writer (direct)"
+           : use_direct_io ? "buffered_file_writer (no direct)"
+                           : "buffered_file_writer",
+           record_count, size);
+  }
+
+  std::string content;
+  for (i32 i = 0; content.size() < MB(usize{64}); ++i) {
+    content += records[i & 1023];
+  }
+  timer.tick();
+  beard::io::write_whole_file(filename, content);
+  timer.tick();
+  fmt::print("  {:<32} {:6.0f} MB/s\n", "write_whole_file (64 MB)",
+             content.size() / timer.delta_time() * 1e-6);
+  beard::io::write_whole_file_atomic(filename, content);
+  timer.tick();
+  fmt::print("  {:<32} {:6.0f} MB/s\n", "write_whole_file_atomic (64 MB)",
+             content.size() / timer.delta_time() * 1e-6);
+
+  std::remove(filename);
+  return 0;
+}
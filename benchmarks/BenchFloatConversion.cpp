@@ -0,0 +1,73 @@
+#include <beard/containers/array.h>
+#include <beard/fmt/fmt.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <charconv>
+#include <random>
+#include <string>
+
+// Usage: BenchFloatConversion [value_count]
+int main(int argc, char** argv) {
+  i32 count = 10'000'000;
+  if (argc > 1) {
+    count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  // Half measurements with a few decimals, half arbitrary doubles
+  std::mt19937_64 rng{42};
+  std::uniform_real_distribution<f64> distribution{-1e6, 1e6};
+  beard::array<f64> values;
+  for (i32 i = 0; i < count; ++i) {
+    f64 value = distribution(rng);
+    values.add(i % 2 == 0 ? static_cast<i64>(value * 1000) / 1000.0 : value);
+  }
+
+  char buffer[beard::fmt::FORMAT_NUMBER_BUFFER_SIZE];
+  std::string text;
+  text.reserve(static_cast<usize>(count) * 24);
+  beard::timer timer;
+  for (f64 value : values) {
+    text.append(buffer, beard::fmt::format_number(value, buffer));
+    text.push_back(' ');
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.1f} ns/value\n", "format_number",
+             timer.delta_time_ns() / static_cast<f64>(count));
+
+  std::string reference_text;
+  reference_text.reserve(text.capacity());
+  timer.tick();
+  for (f64 value : values) {
+    reference_text.append(
+        buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+    reference_text.push_back(' ');
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.1f} ns/value\n", "std::to_chars",
+             timer.delta_time_ns() / static_cast<f64>(count));
+
+  auto tokens = beard::fmt::tokenize(text, " ");
+
+  f64 sum = 0;
+  timer.tick();
+  for (auto token : tokens) {
+    sum += beard::fmt::parse_number<f64>(token).value();
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.1f} ns/value [{}]\n", "parse_number<f64>",
+             timer.delta_time_ns() / static_cast<f64>(count), sum);
+
+  sum = 0;
+  timer.tick();
+  for (auto token : tokens) {
+    f64 value = 0;
+    std::from_chars(token.data(), token.data() + token.size(), value);
+    sum += value;
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.1f} ns/value [{}]\n", "std::from_chars",
+             timer.delta_time_ns() / static_cast<f64>(count), sum);
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <beard/containers/array.h>
+#include <beard/fmt/fmt.h>
+#include <beard/misc/timer.h>
+#include <fmt/format.h>
+
+#include <charconv>
+#include <random>
+#include <span>
+#include <string>
+
+template <typename Fn>
+void measure(const char* name, i32 count, Fn&& fn) {
+  beard::timer timer;
+  usize result = fn();
+  timer.tick();
+  fmt::print("  {:<32} {:6.2f} ns/value [{}]\n", name,
+             timer.delta_time_ns() / static_cast<f64>(count), result);
+}
+
+// Usage: BenchFormatInteger [value_count]
+int main(int argc, char** argv) {
+  i32 count = 20'000'000;
+  if (argc > 1) {
+    count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  // Same mix as BenchParseNumbers: small ids and big 64 bits values
+  std::mt19937_64 rng{42};
+  beard::array<i64> values;
+  values.reserve(count);
+  for (i32 i = 0; i < count; ++i) {
+    u64 value = rng() % 4 == 0 ? rng() >> 1 : rng() % 100000;
+    values.add(static_cast<i64>(rng() % 8 == 0 ? 0 - value : value));
+  }
+
+  std::string output(values.element_count() *
+                         (beard::fmt::MAX_INTEGER_LENGTH<i64> + 1),
+                     '\0');
+
+  measure("std::to_chars", count, [&] {
+    char* p = output.data();
+    for (i64 value : values) {
+      p = std::to_chars(p, p + beard::fmt::MAX_INTEGER_LENGTH<i64>, value).ptr;
+      *p++ = ',';
+    }
+    return static_cast<usize>(p - output.data());
+  });
+
+  measure("fmt::format_int", count, [&] {
+    char* p = output.data();
+    for (i64 value : values) {
+      fmt::format_int formatted{value};
+      memcpy(p, formatted.data(), formatted.size());
+      p += formatted.size();
+      *p++ = ',';
+    }
+    return static_cast<usize>(p - output.data());
+  });
+
+  measure("format_integer", count, [&] {
+    char* p = output.data();
+    for (i64 value : values) {
+      p = beard::fmt::format_integer(value, p);
+      *p++ = ',';
+    }
+    return static_cast<usize>(p - output.data());
+  });
+
+  measure("format_integers", count, [&] {
+    std::span<const i64> column{values.data(),
+                                static_cast<usize>(values.element_count())};
+    char* end = beard::fmt::format_integers(column, ",", output.data());
+    return static_cast<usize>(end - output.data());
+  });
+
+  return 0;
+}
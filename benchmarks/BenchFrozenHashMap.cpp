@@ -0,0 +1,62 @@
+#include <beard/containers/frozen_hash_map.h>
+#include <beard/containers/hash_map.h>
+#include <beard/fmt/fmt.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <cstdio>
+#include <string>
+
+// Usage: BenchFrozenHashMap [element_count]
+int main(int argc, char** argv) {
+  i32 count = 10'000'000;
+  if (argc > 1) {
+    count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  const char* filename = "bench_frozen_hash_map.bin";
+
+  beard::timer timer;
+
+  beard::string_hash_map<u64> map;
+  for (i32 i = 0; i < count; ++i) {
+    map.add("key_" + std::to_string(i), static_cast<u64>(i) * 3);
+  }
+  timer.tick();
+  fmt::print("build string_hash_map ({} entries): {:.3f}s\n", count,
+             timer.delta_time());
+
+  timer.tick();
+  beard::frozen_string_hash_map<u64>::write(filename, map);
+  timer.tick();
+  fmt::print("serialize + write: {:.3f}s\n", timer.delta_time());
+
+  timer.tick();
+  beard::frozen_string_hash_map<u64> frozen;
+  bool loaded = frozen.load(filename);
+  timer.tick();
+  fmt::print("load (mmap): {:.6f}s, ok: {}\n", timer.delta_time(), loaded);
+
+  u64 sum = 0;
+  timer.tick();
+  for (i32 i = 0; i < count; ++i) {
+    auto key = "key_" + std::to_string(i);
+    sum += frozen.get_value_or(key, 0);
+  }
+  timer.tick();
+  fmt::print("lookups (frozen, cold pages): {:.3f}s ({} ns/op) [{}]\n",
+             timer.delta_time(), timer.delta_time_ns() / count, sum);
+
+  sum = 0;
+  timer.tick();
+  for (i32 i = 0; i < count; ++i) {
+    auto key = "key_" + std::to_string(i);
+    sum += map.get_value_or(key, 0);
+  }
+  timer.tick();
+  fmt::print("lookups (string_hash_map): {:.3f}s ({} ns/op) [{}]\n",
+             timer.delta_time(), timer.delta_time_ns() / count, sum);
+
+  std::remove(filename);
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include <beard/containers/array.h>
+#include <beard/fmt/fmt.h>
+#include <beard/io/integer_codec.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <utility>
+
+// Usage: BenchIntegerCodec [count_in_millions]
+// Encodes sorted ids and small values, then decodes them back into the same
+// arrays, as a column reader would
+int main(int argc, char** argv) {
+  i32 count = 16 << 20;
+  if (argc > 1) {
+    count = beard::fmt::parse_number<i32>(argv[1]).value() << 20;
+  }
+
+  beard::array<u32> ids;
+  beard::array<u32> small_values;
+  ids.reserve(count);
+  small_values.reserve(count);
+  u32 id = 1000000;
+  for (i32 i = 0; i < count; ++i) {
+    u32 random = static_cast<u32>(i) * 2654435761u;
+    id += 1 + (random >> 28);
+    ids.add(id);
+    small_values.add((random >> 8) % (random % 16 == 0 ? 5000 : 100));
+  }
+  fmt::print("{}M integers\n", count >> 20);
+
+  auto span_of = [](auto& values) {
+    return std::span{values.data(), static_cast<usize>(values.element_count())};
+  };
+
+  beard::timer timer;
+  beard::array<u32> decoded;
+  auto bench = [&](std::string_view name, const beard::array<u32>& values,
+                   const std::string& encoded, auto decode) {
+    // The first decode sizes the array
+    decode(encoded, decoded);
+    timer.tick();
+    constexpr i32 RUN_COUNT = 5;
+    for (i32 i = 0; i < RUN_COUNT; ++i) {
+      decode(encoded, decoded);
+    }
+    timer.tick();
+    bool is_valid = decoded.element_count() == values.element_count() &&
+                    std::equal(values.begin(), values.end(), decoded.begin());
+    fmt::print("  {:<32} {:6.0f} M/s  ratio {:5.2f}{}\n", name,
+               RUN_COUNT * count / timer.delta_time() * 1e-6,
+               static_cast<f64>(values.data_size()) / encoded.size(),
+               is_valid ? "" : "  (round trip failed)");
+  };
+
+  auto decode_varints = [](const std::string& encoded, auto& values) {
+    beard::io::decode_varints(encoded, values);
+  };
+  auto unpack = [](const std::string& encoded, auto& values) {
+    beard::io::unpack_integers(encoded, values);
+  };
+  auto decode_delta_varints = [&](const std::string& encoded, auto& values) {
+    beard::io::decode_varints(encoded, values);
+    beard::io::delta_decode(span_of(values));
+  };
+
+  std::string encoded;
+  beard::io::encode_varints(span_of(std::as_const(small_values)), encoded);
+  bench("small values, varint", small_values, encoded, decode_varints);
+
+  encoded.clear();
+  beard::io::pack_integers(span_of(std::as_const(small_values)), encoded);
+  bench("small values, packed", small_values, encoded, unpack);
+
+  beard::array<u32> deltas = ids;
+  beard::io::delta_encode(span_of(deltas));
+  encoded.clear();
+  beard::io::encode_varints(span_of(std::as_const(deltas)), encoded);
+  bench("sorted ids, delta varint", ids, encoded, decode_delta_varints);
+
+  encoded.clear();
+  beard::io::pack_integers(span_of(std::as_const(ids)), encoded,
+                           beard::io::bit_packing::mode::delta);
+  bench("sorted ids, delta packed", ids, encoded, unpack);
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <beard/fmt/fmt.h>
+#include <beard/fmt/json.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <random>
+#include <string>
+
+// Usage: BenchJson [size_in_mb]
+int main(int argc, char** argv) {
+  usize size = MB(usize{256});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  // Log lines: a timestamp, a level, a message (sometimes with escapes), a
+  // latency and a small nested object
+  std::mt19937_64 rng{42};
+  const char* levels[] = {"debug", "info", "warning", "error"};
+  std::string text;
+  text.reserve(size + 512);
+  for (u64 id = 0; text.size() < size; ++id) {
+    text += R"({"timestamp": )";
+    text += std::to_string(1700000000000 + id);
+    text += R"(, "level": ")";
+    text += levels[rng() % 4];
+    text += R"(", "message": ")";
+    text += rng() % 8 == 0 ? R"(request \"GET /index.html\" done)"
+                           : "request done";
+    text += R"(", "latency": )";
+    text += std::to_string(rng() % 100000 / 1000.0);
+    text += R"(, "tags": ["web", "eu-west"], "user": {"id": )";
+    text += std::to_string(rng() % 10000);
+    text += R"(, "name": "user"}})";
+    text += '\n';
+  }
+  fmt::print("{} MB of ndjson\n", text.size() >> 20);
+
+  // The first parse grows the index, time the next one
+  beard::fmt::json_document document;
+  document.parse(text);
+  beard::timer timer;
+  document.parse(text);
+  timer.tick();
+  fmt::print("  {:<32} {:6.0f} MB/s\n", "structural index",
+             text.size() / timer.delta_time() * 1e-6);
+
+  f64 total = 0;
+  i64 errors = 0;
+  timer.tick();
+  beard::fmt::ndjson_reader reader{text};
+  beard::fmt::json_value line;
+  while (reader.next(line)) {
+    total += line["latency"].get_number<f64>().value();
+    errors += line["level"].get_raw_string().value() == "error";
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.0f} MB/s [{:.0f} {}]\n", "ndjson_reader (2 fields)",
+             text.size() / timer.delta_time() * 1e-6, total, errors);
+
+  total = 0;
+  i64 user_ids = 0;
+  timer.tick();
+  for (auto line : beard::fmt::split_lines(text)) {
+    beard::fmt::json_document line_document;
+    line_document.parse(line);
+    auto root = line_document.root();
+    total += root["latency"].get_number<f64>().value();
+    user_ids += root["user"]["id"].get_number<i64>().value();
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.0f} MB/s [{:.0f} {}]\n",
+             "document per line (3 fields)",
+             text.size() / timer.delta_time() * 1e-6, total, user_ids);
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+#include <beard/fmt/fmt.h>
+#include <beard/io/io.h>
+#include <beard/io/pack.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Usage: BenchPack [file_count]
+// Loads the same small files loose and from a pack, both in the page cache.
+// Reading from the pack includes mapping it, and touching every byte.
+int main(int argc, char** argv) {
+  i32 file_count = 20000;
+  if (argc > 1) {
+    file_count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  namespace fs = std::filesystem;
+  fs::path directory = "bench_pack";
+  fs::create_directories(directory);
+
+  beard::io::pack_builder builder;
+  std::vector<std::string> paths;
+  std::vector<std::string> names;
+  for (i32 i = 0; i < file_count; ++i) {
+    names.push_back(fmt::format("textures/asset_{}.bin", i));
+    paths.push_back((directory / fmt::format("asset_{}.bin", i)).string());
+    usize size = 512 + (i * 7919) % 8192;
+    beard::io::write_whole_file(paths.back(), std::string(size, 'x'));
+    builder.add_file(names.back(), paths.back());
+  }
+
+  const char* pack_filename = "bench_pack.pack";
+  beard::timer timer;
+  builder.write(pack_filename);
+  timer.tick();
+  fmt::print("{} files, packed in {:.3f}s\n", file_count, timer.delta_time());
+
+  auto sum = [](std::string_view content) {
+    usize sum = 0;
+    for (char c : content) {
+      sum += static_cast<u8>(c);
+    }
+    return sum;
+  };
+
+  timer.tick();
+  usize total = 0;
+  for (const auto& path : paths) {
+    total += sum(beard::io::read_whole_file(path));
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:8.0f} files/s [{}]\n", "read_whole_file",
+             file_count / timer.delta_time(), total);
+
+  timer.tick();
+  beard::io::pack_file pack;
+  pack.open(pack_filename);
+  total = 0;
+  for (const auto& name : names) {
+    total += sum(pack.find(name).value());
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:8.0f} files/s [{}]\n", "pack_file::find",
+             file_count / timer.delta_time(), total);
+
+  // Everything is mapped now, only the lookups are left
+  timer.tick();
+  total = 0;
+  for (const auto& name : names) {
+    total += pack.find(name).value().size();
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:8.1f} M lookups/s [{}]\n", "pack_file::find (lookup)",
+             file_count / timer.delta_time() * 1e-6, total);
+
+  timer.tick();
+  bool is_valid = pack.verify();
+  timer.tick();
+  fmt::print("  {:<32} {:8.0f} files/s [{}]\n", "pack_file::verify",
+             file_count / timer.delta_time(), is_valid);
+
+  pack.close();
+  std::remove(pack_filename);
+  fs::remove_all(directory);
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include <beard/containers/array.h>
+#include <beard/fmt/fmt.h>
+#include <beard/fmt/parallel_parse.h>
+#include <beard/misc/thread_pool.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <random>
+#include <string>
+#include <thread>
+
+// Usage: BenchParallelParse [size_in_mb]
+int main(int argc, char** argv) {
+  usize size = MB(usize{512});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  // One record per line: an id and a few measurements
+  std::mt19937_64 rng{42};
+  std::string text;
+  text.reserve(size + 128);
+  while (text.size() < size) {
+    text += std::to_string(rng() % 1000000);
+    for (i32 i = 0; i < 4; ++i) {
+      text += ' ';
+      text += std::to_string(rng() % 100000);
+    }
+    text += '\n';
+  }
+  fmt::print("{} MB of records\n", text.size() >> 20);
+
+  auto parse_chunk = [](std::string_view chunk) {
+    beard::array<i64> values;
+    beard::fmt::parse_numbers(chunk, values);
+    return values;
+  };
+
+  beard::timer timer;
+  auto values = parse_chunk(text);
+  timer.tick();
+  f64 single_thread_time = timer.delta_time();
+  fmt::print("  {:<12} {:6.2f} GB/s ({} values)\n", "1 thread",
+             text.size() / single_thread_time * 1e-9, values.element_count());
+
+  i32 max_thread_count =
+      static_cast<i32>(std::thread::hardware_concurrency());
+  for (i32 thread_count = 2; thread_count <= max_thread_count;
+       thread_count *= 2) {
+    beard::thread_pool pool{thread_count};
+    timer.tick();
+    auto results = beard::fmt::parse_parallel(text, parse_chunk, '\0', pool);
+    timer.tick();
+
+    i32 value_count = 0;
+    for (const auto& chunk_values : results) {
+      value_count += chunk_values.element_count();
+    }
+    fmt::print("  {:<12} {:6.2f} GB/s ({} values, {:.1f}x)\n",
+               fmt::format("{} threads", thread_count),
+               text.size() / timer.delta_time() * 1e-9, value_count,
+               single_thread_time / timer.delta_time());
+  }
+
+  return 0;
+}
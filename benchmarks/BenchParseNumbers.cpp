@@ -0,0 +1,47 @@
+#include <beard/containers/array.h>
+#include <beard/fmt/fmt.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <random>
+#include <string>
+
+// Usage: BenchParseNumbers [size_in_mb]
+int main(int argc, char** argv) {
+  usize size = MB(usize{1024});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  // Mix of small ids and big 64 bits values, like our ingest files
+  std::mt19937_64 rng{42};
+  std::string text;
+  text.reserve(size + 32);
+  while (text.size() < size) {
+    u64 value = rng() % 4 == 0 ? rng() >> 1 : rng() % 100000;
+    text += std::to_string(value);
+    text.push_back(rng() % 16 == 0 ? '\n' : ' ');
+  }
+  fmt::print("{} MB of integers\n", text.size() >> 20);
+
+  beard::array<i64> values;
+  beard::timer timer;
+  for (auto token : beard::fmt::tokenize_lazy(text, " \n")) {
+    values.add(beard::fmt::parse_number<i64>(token).value());
+  }
+  timer.tick();
+  fmt::print("  {:<32} {:6.2f} GB/s ({} values)\n",
+             "tokenize_lazy + parse_number",
+             text.size() / timer.delta_time() * 1e-9,
+             values.element_count());
+
+  values.clear();
+  timer.tick();
+  auto result = beard::fmt::parse_numbers(text, values);
+  timer.tick();
+  fmt::print("  {:<32} {:6.2f} GB/s ({} values, ok: {})\n", "parse_numbers",
+             text.size() / timer.delta_time() * 1e-9, result.parsed_count,
+             result.ok());
+
+  return 0;
+}
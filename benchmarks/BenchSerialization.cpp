@@ -0,0 +1,101 @@
+#include <beard/containers/array.h>
+#include <beard/containers/hash_map.h>
+#include <beard/fmt/fmt.h>
+#include <beard/io/serialization.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+// Usage: BenchSerialization [count_in_millions]
+// Saves and loads an array<u64> through a file in the page cache, against
+// reading it back one element at a time, then a string keyed map
+int main(int argc, char** argv) {
+  i32 count = 16 << 20;
+  if (argc > 1) {
+    count = beard::fmt::parse_number<i32>(argv[1]).value() << 20;
+  }
+
+  beard::array<u64> values;
+  values.reserve(count);
+  for (i32 i = 0; i < count; ++i) {
+    values.add(static_cast<u64>(i) * 0x9e3779b97f4a7c15ull);
+  }
+  fmt::print("{}M u64\n", count >> 20);
+
+  const char* filename = "bench_serialization.bin";
+  beard::timer timer;
+  auto report = [&](std::string_view name, usize size) {
+    timer.tick();
+    fmt::print("  {:<32} {:8.3f}s {:6.0f} MB/s\n", name, timer.delta_time(),
+               size / timer.delta_time() * 1e-6);
+  };
+
+  timer.tick();
+  {
+    beard::io::binary_writer writer;
+    writer.open(filename);
+    writer.write_header(1);
+    writer.write(values);
+    writer.close();
+  }
+  report("save array", values.data_size());
+
+  beard::array<u64> loaded;
+  {
+    beard::io::binary_reader reader;
+    reader.open(filename);
+    reader.read_header();
+    reader.read(loaded);
+  }
+  report("load array", values.data_size());
+
+  beard::array<u64> slow_loaded;
+  {
+    beard::io::binary_reader reader;
+    reader.open(filename);
+    reader.read_header();
+    usize slow_count = 0;
+    reader.read_count(slow_count, sizeof(u64));
+    slow_loaded.resize(static_cast<i32>(slow_count));
+    for (u64& value : slow_loaded) {
+      reader.read(value);
+    }
+  }
+  report("load one element at a time", values.data_size());
+  if (!std::equal(values.begin(), values.end(), loaded.begin()) ||
+      !std::equal(values.begin(), values.end(), slow_loaded.begin())) {
+    fmt::print("Round trip failed\n");
+    return 1;
+  }
+
+  beard::hash_map<std::string, u32> map;
+  for (i32 i = 0; i < count / 16; ++i) {
+    map.add(fmt::format("key_{}", i), static_cast<u32>(i));
+  }
+  std::string bytes;
+  timer.tick();
+  {
+    beard::io::binary_writer writer{bytes};
+    writer.write_header(1);
+    writer.write(map);
+  }
+  report("save hash_map<string, u32>", bytes.size());
+
+  beard::hash_map<std::string, u32> loaded_map;
+  {
+    beard::io::binary_reader reader{bytes};
+    reader.read_header();
+    reader.read(loaded_map);
+  }
+  report("load hash_map<string, u32>", bytes.size());
+  if (loaded_map.element_count() != map.element_count()) {
+    fmt::print("Round trip failed\n");
+    return 1;
+  }
+
+  std::remove(filename);
+  return 0;
+}
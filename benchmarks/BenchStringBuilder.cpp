@@ -0,0 +1,80 @@
+#include <beard/fmt/fmt.h>
+#include <beard/fmt/string_builder.h>
+#include <beard/misc/timer.h>
+#include <fmt/format.h>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// Count heap allocations, which are what we want to get rid of
+global_variable usize g_allocation_count = 0;
+
+void* operator new(usize size) {
+  ++g_allocation_count;
+  if (void* p = malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, usize) noexcept { free(p); }
+
+struct record {
+  i64 id;
+  const char* name;
+  f64 price;
+  i32 quantity;
+};
+
+template <typename Fn>
+void measure(const char* name, i32 count, Fn&& fn) {
+  usize allocations = g_allocation_count;
+  beard::timer timer;
+  usize result = fn();
+  timer.tick();
+  fmt::print("  {:<28} {:6.1f} ns/record, {:5.2f} allocations/record [{}]\n",
+             name, timer.delta_time_ns() / static_cast<f64>(count),
+             static_cast<f64>(g_allocation_count - allocations) / count,
+             result);
+}
+
+// Usage: BenchStringBuilder [record_count]
+int main(int argc, char** argv) {
+  i32 count = 5'000'000;
+  if (argc > 1) {
+    count = beard::fmt::parse_number<i32>(argv[1]).value();
+  }
+
+  record r = {0, "a product with a rather long name", 12.5, 3};
+
+  measure("std::string + fmt::format", count, [&] {
+    usize total = 0;
+    for (i32 i = 0; i < count; ++i) {
+      r.id = i;
+      std::string line = std::to_string(r.id) + "," + r.name + ",";
+      line += fmt::format("{},{}", r.price, r.quantity);
+      line += '\n';
+      total += line.size();
+    }
+    return total;
+  });
+
+  measure("string_builder", count, [&] {
+    usize total = 0;
+    beard::fmt::string_builder line;
+    for (i32 i = 0; i < count; ++i) {
+      r.id = i;
+      line.reset();
+      line.append_number(r.id);
+      line.append(',');
+      line.append(r.name);
+      line.format(",{},{}\n", r.price, r.quantity);
+      total += line.size();
+    }
+    return total;
+  });
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include <beard/fmt/fmt.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <random>
+#include <string>
+
+// tokenize before the SIMD delimiter scanning, as a reference
+usize count_tokens_reference(std::string_view input, std::string_view token) {
+  usize count = 0;
+  auto curr_str = input;
+  usize offset;
+  while ((offset = curr_str.find_first_of(token)) != std::string_view::npos) {
+    count += offset != 0;
+    curr_str = curr_str.substr(offset + 1);
+  }
+  return count + !curr_str.empty();
+}
+
+usize count_tokens_lazy(std::string_view input, std::string_view token) {
+  usize count = 0;
+  for (auto t : beard::fmt::tokenize_lazy(input, token)) {
+    count += !t.empty();
+  }
+  return count;
+}
+
+usize count_lines(std::string_view input) {
+  usize count = 0;
+  for (auto line : beard::fmt::split_lines(input)) {
+    count += line.size() != 0;
+  }
+  return count;
+}
+
+template <typename Fn>
+void measure(const char* name, std::string_view text, Fn&& fn) {
+  beard::timer timer;
+  usize result = fn();
+  timer.tick();
+  fmt::print("  {:<28} {:6.2f} GB/s [{}]\n", name,
+             text.size() / timer.delta_time() * 1e-9, result);
+}
+
+// Usage: BenchTokenize [size_in_mb]
+int main(int argc, char** argv) {
+  usize size = MB(usize{256});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  // Words of 1 to 12 letters, separated by spaces, commas or new lines
+  std::mt19937 rng{42};
+  std::string text;
+  text.reserve(size + 16);
+  while (text.size() < size) {
+    text.append(1 + rng() % 12, static_cast<char>('a' + rng() % 26));
+    u32 r = rng() % 16;
+    text.push_back(r == 0 ? '\n' : r < 4 ? ',' : ' ');
+  }
+
+  fmt::print("{} MB of text\n", text.size() >> 20);
+
+  fmt::print("single delimiter \" \"\n");
+  measure("find_first_of (reference)", text,
+          [&] { return count_tokens_reference(text, " "); });
+  measure("tokenize_lazy", text, [&] { return count_tokens_lazy(text, " "); });
+
+  fmt::print("delimiter set \" ,\\n\\t\"\n");
+  measure("find_first_of (reference)", text,
+          [&] { return count_tokens_reference(text, " ,\n\t"); });
+  measure("tokenize_lazy", text,
+          [&] { return count_tokens_lazy(text, " ,\n\t"); });
+
+  fmt::print("lines\n");
+  measure("find_first_of (reference)", text,
+          [&] { return count_tokens_reference(text, "\n"); });
+  measure("split_lines", text, [&] { return count_lines(text); });
+
+  return 0;
+}
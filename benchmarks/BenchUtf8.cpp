@@ -0,0 +1,52 @@
+#include <beard/fmt/fmt.h>
+#include <beard/fmt/utf8.h>
+#include <beard/misc/timer.h>
+#include <fmt/core.h>
+
+#include <random>
+#include <string>
+
+template <typename Fn>
+void measure(const char* name, usize size, Fn&& fn) {
+  beard::timer timer;
+  auto result = fn();
+  timer.tick();
+  fmt::print("  {:<28} {:6.2f} GB/s [{}]\n", name,
+             size / timer.delta_time() * 1e-9, result);
+}
+
+// Usage: BenchUtf8 [size_in_mb]
+int main(int argc, char** argv) {
+  usize size = MB(usize{256});
+  if (argc > 1) {
+    size = MB(beard::fmt::parse_number<usize>(argv[1]).value());
+  }
+
+  // Mostly ascii, like our ingest files, and text in several scripts
+  std::mt19937_64 rng{42};
+  std::string ascii;
+  std::string mixed;
+  ascii.reserve(size + 16);
+  mixed.reserve(size + 16);
+  const char* words[] = {"beard", "caf\xc3\xa9", "\xd0\xb1\xd0\xbe\xd1\x80",
+                         "\xe6\x97\xa5\xe6\x9c\xac", "\xf0\x9f\x98\x80"};
+  while (ascii.size() < size) {
+    ascii += "beard library ";
+  }
+  while (mixed.size() < size) {
+    mixed += words[rng() % 5];
+    mixed += ' ';
+  }
+
+  std::u32string decoded(size, U'\0');
+  for (auto [name, text] : {std::pair{"ascii", &ascii}, {"mixed", &mixed}}) {
+    fmt::print("{} MB of {} text\n", text->size() >> 20, name);
+    measure("is_valid_utf8", text->size(),
+            [&] { return beard::fmt::is_valid_utf8(*text); });
+    measure("utf8_to_utf32", text->size(), [&] {
+      return beard::fmt::utf8_to_utf32(*text, decoded.data()).written_count;
+    });
+  }
+
+  return 0;
+}
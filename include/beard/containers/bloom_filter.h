@@ -0,0 +1,121 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/hash.h"
+
+namespace beard {
+// Blocked bloom filter: each key only touches a single 32 bytes block (so a
+// single cache line), setting one bit in each of the 8 words of the block.
+// This costs a few more bits per key than a classic bloom filter for the same
+// false positive rate, but every query is one cache miss at most.
+//
+// Keys are hashed with beard::hash64, the *_hash variants take an already
+// computed hash for callers that have one at hand.
+class bloom_filter {
+ public:
+  struct alignas(32) block {
+    u32 words[8];
+  };
+
+  bloom_filter() = default;
+  bloom_filter(u64 expected_element_count, f64 false_positive_rate);
+  ~bloom_filter() = default;
+
+  DEFAULT_CTORS(bloom_filter);
+
+  void add(std::string_view key) { add_hash(hash64::hash(key)); }
+  bool contains(std::string_view key) const {
+    return contains_hash(hash64::hash(key));
+  }
+
+  inline void add_hash(u64 hash);
+  inline bool contains_hash(u64 hash) const;
+
+  // Bulk versions, hashing and prefetching a batch of keys before touching
+  // the blocks so that the cache misses overlap. They use AVX2 when the CPU
+  // has it.
+  void add_all(std::span<const std::string_view> keys);
+  void add_all_hashes(std::span<const u64> hashes);
+  // results[i] is set to 1 if keys[i] may be in the filter, 0 otherwise
+  void contains_all(std::span<const std::string_view> keys,
+                    array<u8>& results) const;
+  void contains_all_hashes(std::span<const u64> hashes,
+                           array<u8>& results) const;
+
+  // Union of two filters, which must have been created with the same size.
+  // Returns false (and does nothing) if they were not.
+  bool merge(const bloom_filter& other);
+
+  void clear();
+
+  // The serialized filter uses the native endianness
+  std::string serialize() const;
+  bool deserialize(std::string_view bytes);
+
+  i32 block_count() const { return m_blocks.element_count(); }
+  usize memory_size() const { return m_blocks.data_size(); }
+
+  // Expected false positive rate of a filter using bits_per_key bits per
+  // inserted key
+  static f64 false_positive_rate(f64 bits_per_key);
+
+ private:
+  inline const block& block_for(u64 hash) const;
+  inline block& block_for(u64 hash);
+
+  array<block> m_blocks;
+};
+
+namespace bloom_detail {
+static constexpr u32 SALT[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                                0xa2b7289dU, 0x705495c7U, 0x2df1424bU,
+                                0x9efc4947U, 0x5c6bfb31U};
+
+// The high half of the hash selects the block, the low half the bits
+inline u64 block_index(u64 hash, u64 block_count) {
+  return ((hash >> 32) * block_count) >> 32;
+}
+
+inline void set_bits(bloom_filter::block& b, u32 key) {
+  for (i32 i = 0; i < 8; ++i) {
+    b.words[i] |= u32{1} << ((key * SALT[i]) >> 27);
+  }
+}
+
+inline bool has_bits(const bloom_filter::block& b, u32 key) {
+  u32 missing = 0;
+  for (i32 i = 0; i < 8; ++i) {
+    u32 mask = u32{1} << ((key * SALT[i]) >> 27);
+    missing |= mask & ~b.words[i];
+  }
+  return missing == 0;
+}
+}  // namespace bloom_detail
+
+inline const bloom_filter::block& bloom_filter::block_for(u64 hash) const {
+  u64 count = static_cast<u64>(m_blocks.element_count());
+  return m_blocks[static_cast<i32>(bloom_detail::block_index(hash, count))];
+}
+
+inline bloom_filter::block& bloom_filter::block_for(u64 hash) {
+  u64 count = static_cast<u64>(m_blocks.element_count());
+  return m_blocks[static_cast<i32>(bloom_detail::block_index(hash, count))];
+}
+
+inline void bloom_filter::add_hash(u64 hash) {
+  ASSERT(!m_blocks.is_empty(), "Adding to a filter that has not been sized");
+  bloom_detail::set_bits(block_for(hash), static_cast<u32>(hash));
+}
+
+inline bool bloom_filter::contains_hash(u64 hash) const {
+  if (m_blocks.is_empty()) {
+    return false;
+  }
+  return bloom_detail::has_bits(block_for(hash), static_cast<u32>(hash));
+}
+}  // namespace beard
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/hash.h"
+
+namespace beard {
+// Cuckoo filter: approximate set membership, like bloom_filter, but keys can
+// also be removed. Each key is reduced to a small fingerprint stored in one
+// of two candidate buckets of 4 slots. A bucket fits in a single u64, and
+// looking a fingerprint up in it is a couple of bit tricks. Fingerprints
+// always take 16 bits of storage, lowering the requested false positive rate
+// only uses more of them.
+//
+// Removing a key that was never added can remove another key sharing the
+// same fingerprint, so only remove what has been added.
+class cuckoo_filter {
+ public:
+  cuckoo_filter() = default;
+  cuckoo_filter(u64 expected_element_count, f64 false_positive_rate);
+  ~cuckoo_filter() = default;
+
+  DEFAULT_CTORS(cuckoo_filter);
+
+  // Returns false when the filter is too full to accept the key
+  bool add(std::string_view key) { return add_hash(hash64::hash(key)); }
+  bool contains(std::string_view key) const {
+    return contains_hash(hash64::hash(key));
+  }
+  bool remove(std::string_view key) { return remove_hash(hash64::hash(key)); }
+
+  bool add_hash(u64 hash);
+  inline bool contains_hash(u64 hash) const;
+  bool remove_hash(u64 hash);
+
+  // Bulk versions, prefetching both buckets of a batch of keys before
+  // touching them. They return the number of keys successfully added or
+  // removed, results[i] is set to 1 if keys[i] may be in the filter.
+  i32 add_all(std::span<const std::string_view> keys);
+  void contains_all(std::span<const std::string_view> keys,
+                    array<u8>& results) const;
+  i32 remove_all(std::span<const std::string_view> keys);
+
+  void clear();
+
+  i32 element_count() const { return m_element_count; }
+  i32 bucket_count() const { return m_buckets.element_count(); }
+  u32 fingerprint_bits() const { return m_fingerprint_bits; }
+  usize memory_size() const { return m_buckets.data_size(); }
+  f64 load_factor() const {
+    return m_buckets.is_empty()
+               ? 0.0
+               : static_cast<f64>(m_element_count) / (bucket_count() * 4);
+  }
+
+ private:
+  static constexpr u64 LOW_BITS = 0x0001000100010001ull;
+  static constexpr u64 HIGH_BITS = 0x8000800080008000ull;
+
+  struct location {
+    u64 first_bucket;
+    u64 second_bucket;
+    u16 fingerprint;
+  };
+
+  inline location locate(u64 hash) const;
+  inline u64 alternate_bucket(u64 bucket, u16 fingerprint) const;
+
+  // Non zero if one of the 16 bits lanes of the bucket holds the fingerprint
+  static u64 match(u64 bucket, u16 fingerprint) {
+    u64 v = bucket ^ (LOW_BITS * fingerprint);
+    return (v - LOW_BITS) & ~v & HIGH_BITS;
+  }
+
+  bool insert(u64 bucket, u16 fingerprint);
+  bool erase(u64 bucket, u16 fingerprint);
+
+  array<u64> m_buckets;
+  u64 m_bucket_mask = 0;
+  u16 m_fingerprint_mask = 0;
+  u32 m_fingerprint_bits = 0;
+  i32 m_element_count = 0;
+  u64 m_random_state = 0x2545f4914f6cdd1dull;
+
+  // A fingerprint that could not find a place after all the kicks. Keeping
+  // it around instead of dropping it means no key is ever lost.
+  bool m_has_victim = false;
+  u64 m_victim_bucket = 0;
+  u16 m_victim_fingerprint = 0;
+};
+
+inline cuckoo_filter::location cuckoo_filter::locate(u64 hash) const {
+  // Fingerprints come from the low bits, buckets from the high ones. A zero
+  // fingerprint marks an empty slot so it is never used.
+  u16 fingerprint = static_cast<u16>(hash) & m_fingerprint_mask;
+  fingerprint += fingerprint == 0;
+  u64 bucket = (hash >> 32) & m_bucket_mask;
+  return {bucket, alternate_bucket(bucket, fingerprint), fingerprint};
+}
+
+inline u64 cuckoo_filter::alternate_bucket(u64 bucket, u16 fingerprint) const {
+  // Partial key cuckoo hashing: the other bucket only depends on the current
+  // one and the fingerprint, and applying it twice goes back to the start
+  return (bucket ^ (fingerprint * 0x5bd1e995ull)) & m_bucket_mask;
+}
+
+inline bool cuckoo_filter::contains_hash(u64 hash) const {
+  if (m_buckets.is_empty()) {
+    return false;
+  }
+
+  auto [first, second, fingerprint] = locate(hash);
+  u64 found = match(m_buckets[static_cast<i32>(first)], fingerprint) |
+              match(m_buckets[static_cast<i32>(second)], fingerprint);
+  return found != 0 ||
+         (m_has_victim && m_victim_fingerprint == fingerprint &&
+          (m_victim_bucket == first || m_victim_bucket == second));
+}
+}  // namespace beard
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "beard/containers/hash_map.h"
+#include "beard/core/macros.h"
+#include "beard/io/io.h"
+#include "beard/misc/hash.h"
+
+namespace beard {
+namespace frozen_detail {
+// "BRDFHM01", little endian
+constexpr u64 MAGIC = 0x31304d4846445242ull;
+constexpr u32 VERSION = 1;
+constexpr u64 SECTION_ALIGNMENT = 64;
+
+// Every position in the file is an offset from the start of the file, so that
+// the blob can be mapped anywhere and used as is.
+struct header {
+  u64 magic;
+  u32 version;
+  u32 slot_size;
+  u64 element_count;
+  u64 slot_count;
+  u64 slots_offset;
+  u64 strings_offset;
+  u64 strings_size;
+  u64 total_size;
+};
+static_assert(sizeof(header) == SECTION_ALIGNMENT);
+
+struct string_ref {
+  u64 offset;
+  u64 length;
+};
+
+inline u64 align_up(u64 value, u64 alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Integer keys are stored inline in the slots
+template <typename Key>
+struct key_traits {
+  static_assert(std::is_integral_v<Key> || std::is_enum_v<Key>,
+                "frozen_hash_map only supports integer and string keys");
+
+  using lookup_type = Key;
+  using stored_type = Key;
+
+  static u64 hash(Key key) { return hash64::hash(static_cast<u64>(key)); }
+
+  static stored_type store(Key key, std::string&) { return key; }
+
+  static lookup_type load(stored_type stored, const char*) { return stored; }
+
+  static bool is_valid(stored_type, u64) { return true; }
+};
+
+// String keys are stored in a separate section, slots only keep a reference
+template <>
+struct key_traits<std::string> {
+  using lookup_type = std::string_view;
+  using stored_type = string_ref;
+
+  static u64 hash(std::string_view key) { return hash64::hash(key); }
+
+  static stored_type store(const std::string& key, std::string& strings) {
+    string_ref ref = {strings.size(), key.size()};
+    strings.append(key);
+    return ref;
+  }
+
+  static lookup_type load(const stored_type& stored, const char* strings) {
+    return {strings + stored.offset, stored.length};
+  }
+
+  // Whether the string lies in a strings section of strings_size bytes
+  static bool is_valid(const stored_type& stored, u64 strings_size) {
+    return stored.offset <= strings_size &&
+           stored.length <= strings_size - stored.offset;
+  }
+};
+
+template <typename Key, typename Value>
+struct slot {
+  u64 hash;  // 0 means empty
+  typename key_traits<Key>::stored_type key;
+  Value value;
+};
+}  // namespace frozen_detail
+
+// Read only hash map that can be written to disk and loaded back by mapping
+// the file, without any parsing or allocation. Values are stored as raw bytes
+// so they have to be trivially copyable, and the file uses the native
+// endianness.
+template <typename Key, typename Value>
+class frozen_hash_map {
+  static_assert(std::is_trivially_copyable_v<Value>,
+                "frozen_hash_map values must be trivially copyable");
+
+  using traits = frozen_detail::key_traits<Key>;
+  using slot = frozen_detail::slot<Key, Value>;
+
+ public:
+  using key_type = typename traits::lookup_type;
+  using value_type = std::pair<key_type, const Value&>;
+
+  class const_iterator {
+   public:
+    struct arrow_proxy {
+      value_type pair;
+      const value_type* operator->() const { return &pair; }
+    };
+
+    const_iterator() = default;
+    const_iterator(const frozen_hash_map* map, u64 index)
+        : m_map{map}, m_index{index} {}
+
+    value_type operator*() const {
+      const slot& s = m_map->m_slots[m_index];
+      return {traits::load(s.key, m_map->m_strings), s.value};
+    }
+
+    arrow_proxy operator->() const { return {**this}; }
+
+    const_iterator& operator++() {
+      ++m_index;
+      m_index = m_map->next_occupied(m_index);
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return m_index == other.m_index;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return m_index != other.m_index;
+    }
+
+   private:
+    const frozen_hash_map* m_map = nullptr;
+    u64 m_index = 0;
+  };
+
+  frozen_hash_map() = default;
+  ~frozen_hash_map() = default;
+
+  NONCOPYABLE(frozen_hash_map);
+  frozen_hash_map(frozen_hash_map&& other) noexcept;
+  frozen_hash_map& operator=(frozen_hash_map&& other) noexcept;
+
+  // Build the on-disk representation of a map
+  static std::string serialize(const hash_map<Key, Value>& map);
+
+  static bool write(std::string_view filename,
+                    const hash_map<Key, Value>& map) {
+    return io::write_whole_file(filename, serialize(map));
+  }
+
+  // Map the file and use it in place
+  bool load(std::string_view filename) {
+    if (!m_file.open(filename)) {
+      return false;
+    }
+    if (!attach(m_file.view())) {
+      m_file.close();
+      return false;
+    }
+    return true;
+  }
+
+  // Use an already loaded blob, which must outlive the map and be aligned
+  // for the slots (any allocation from new or malloc is)
+  bool load_from_memory(std::string_view bytes) {
+    m_file.close();
+    return attach(bytes);
+  }
+
+  const_iterator begin() const { return {this, next_occupied(0)}; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator end() const { return {this, m_slot_count}; }
+  const_iterator cend() const { return end(); }
+
+  bool is_empty() const { return m_element_count == 0; }
+
+  i32 element_count() const { return static_cast<i32>(m_element_count); }
+
+  const_iterator find(const key_type& key) const {
+    return {this, find_index(key)};
+  }
+
+  bool contains(const key_type& key) const { return find(key) != end(); }
+
+  const Value& get_value_or(const key_type& key, const Value& other) const {
+    if (auto index = find_index(key); index != m_slot_count) {
+      return m_slots[index].value;
+    }
+
+    return other;
+  }
+
+ private:
+  static u64 slot_hash(const key_type& key) {
+    u64 hash = traits::hash(key);
+    return hash != 0 ? hash : 1;
+  }
+
+  u64 find_index(const key_type& key) const {
+    if (m_slot_count == 0) {
+      return 0;
+    }
+
+    u64 hash = slot_hash(key);
+    u64 index = hash & (m_slot_count - 1);
+    for (;;) {
+      const slot& s = m_slots[index];
+      if (s.hash == 0) {
+        return m_slot_count;
+      }
+      if (s.hash == hash && traits::load(s.key, m_strings) == key) {
+        return index;
+      }
+      index = (index + 1) & (m_slot_count - 1);
+    }
+  }
+
+  u64 next_occupied(u64 index) const {
+    while (index < m_slot_count && m_slots[index].hash == 0) {
+      ++index;
+    }
+    return index;
+  }
+
+  bool attach(std::string_view bytes);
+
+  io::mapped_file m_file;
+  const slot* m_slots = nullptr;
+  const char* m_strings = nullptr;
+  u64 m_slot_count = 0;
+  u64 m_element_count = 0;
+};
+
+template <typename Value>
+using frozen_string_hash_map = frozen_hash_map<std::string, Value>;
+
+template <typename Key, typename Value>
+frozen_hash_map<Key, Value>::frozen_hash_map(frozen_hash_map&& other) noexcept {
+  *this = std::move(other);
+}
+
+template <typename Key, typename Value>
+frozen_hash_map<Key, Value>& frozen_hash_map<Key, Value>::operator=(
+    frozen_hash_map&& other) noexcept {
+  if (this != &other) {
+    // A mapping keeps its address when m_file moves, so the pointers into it
+    // stay valid, but the source must not see them anymore
+    m_file = std::move(other.m_file);
+    m_slots = other.m_slots;
+    m_strings = other.m_strings;
+    m_slot_count = other.m_slot_count;
+    m_element_count = other.m_element_count;
+    other.m_slots = nullptr;
+    other.m_strings = nullptr;
+    other.m_slot_count = 0;
+    other.m_element_count = 0;
+  }
+  return *this;
+}
+
+template <typename Key, typename Value>
+std::string frozen_hash_map<Key, Value>::serialize(
+    const hash_map<Key, Value>& map) {
+  using namespace frozen_detail;
+
+  // Keep the load factor under 75% so that probing always ends on a hole
+  u64 element_count = map.element_count();
+  u64 slot_count = 8;
+  while (slot_count * 3 < element_count * 4) {
+    slot_count *= 2;
+  }
+
+  std::vector<slot> slots(slot_count);
+  memset(slots.data(), 0, slots.size() * sizeof(slot));
+
+  std::string strings;
+  for (const auto& [key, value] : map) {
+    slot s;
+    memset(&s, 0, sizeof(s));
+    s.key = traits::store(key, strings);
+    s.hash = slot_hash(traits::load(s.key, strings.data()));
+    s.value = value;
+
+    u64 index = s.hash & (slot_count - 1);
+    while (slots[index].hash != 0) {
+      index = (index + 1) & (slot_count - 1);
+    }
+    memcpy(&slots[index], &s, sizeof(s));
+  }
+
+  header h;
+  memset(&h, 0, sizeof(h));
+  h.magic = MAGIC;
+  h.version = VERSION;
+  h.slot_size = sizeof(slot);
+  h.element_count = element_count;
+  h.slot_count = slot_count;
+  h.slots_offset = align_up(sizeof(header), SECTION_ALIGNMENT);
+  h.strings_offset = align_up(h.slots_offset + slot_count * sizeof(slot),
+                              SECTION_ALIGNMENT);
+  h.strings_size = strings.size();
+  h.total_size = h.strings_offset + h.strings_size;
+
+  std::string result(h.total_size, '\0');
+  memcpy(result.data(), &h, sizeof(h));
+  memcpy(result.data() + h.slots_offset, slots.data(),
+         slot_count * sizeof(slot));
+  if (!strings.empty()) {
+    memcpy(result.data() + h.strings_offset, strings.data(), strings.size());
+  }
+
+  return result;
+}
+
+template <typename Key, typename Value>
+bool frozen_hash_map<Key, Value>::attach(std::string_view bytes) {
+  using namespace frozen_detail;
+
+  m_slots = nullptr;
+  m_strings = nullptr;
+  m_slot_count = 0;
+  m_element_count = 0;
+
+  if (bytes.size() < sizeof(header)) {
+    return false;
+  }
+
+  header h;
+  memcpy(&h, bytes.data(), sizeof(h));
+
+  bool valid = h.magic == MAGIC && h.version == VERSION &&
+               h.slot_size == sizeof(slot) && h.total_size == bytes.size() &&
+               h.slot_count != 0 && (h.slot_count & (h.slot_count - 1)) == 0 &&
+               h.element_count < h.slot_count &&
+               h.slots_offset <= h.total_size &&
+               h.slot_count <= (h.total_size - h.slots_offset) / sizeof(slot) &&
+               h.strings_offset <= h.total_size &&
+               h.strings_size <= h.total_size - h.strings_offset;
+  if (!valid) {
+    return false;
+  }
+
+  auto slots = reinterpret_cast<const slot*>(bytes.data() + h.slots_offset);
+  if (reinterpret_cast<usize>(slots) % alignof(slot) != 0) {
+    return false;
+  }
+
+  // Check every slot once here, so that lookups do not have to. Probing ends
+  // on the first empty slot, so there has to be one.
+  u64 element_count = 0;
+  for (u64 i = 0; i < h.slot_count; ++i) {
+    const slot& s = slots[i];
+    if (s.hash == 0) {
+      continue;
+    }
+    ++element_count;
+    if (!traits::is_valid(s.key, h.strings_size)) {
+      return false;
+    }
+  }
+  if (element_count != h.element_count) {
+    return false;
+  }
+
+  m_slots = slots;
+  m_strings = bytes.data() + h.strings_offset;
+  m_slot_count = h.slot_count;
+  m_element_count = h.element_count;
+  return true;
+}
+}  // namespace beard
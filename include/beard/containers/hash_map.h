@@ -43,9 +43,9 @@ class hash_map {
     m_hash_map[std::move(key)] = std::move(value);
   }
 
-  iterator remove(const Key& key) { return m_hash_map.erase(key); }
+  bool remove(const Key& key) { return m_hash_map.erase(key) > 0; }
 
-  iterator remove(Key&& key) { return m_hash_map.erase(key); }
+  bool remove(Key&& key) { return m_hash_map.erase(key) > 0; }
 
   const Value& get_value_or(const Key& key, const Value& other) const {
     if (auto found = m_hash_map.find(key); found != m_hash_map.end()) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <initializer_list>
+#include <string>
 #include <unordered_set>
 
 #include "beard/core/macros.h"
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "beard/core/macros.h"
+
+namespace beard {
+// Instruction sets available on the machine we are running on, to pick SIMD
+// code paths at runtime (see BEARD_TARGET).
+struct cpu_features {
+  bool sse42 = false;
+  bool pclmul = false;
+  bool avx2 = false;
+  bool bmi2 = false;
+};
+
+// Detected once, on first call
+const cpu_features& get_cpu_features();
+}  // namespace beard
@@ -50,6 +50,21 @@
 #error "Unsupported architecture"
 #endif
 
+// Instruction sets enabled at compile time. Code that wants to use wider
+// instructions than the target baseline has to dispatch at runtime.
+#if defined(__AVX2__)
+#define BEARD_HAS_AVX2 1
+#else
+#define BEARD_HAS_AVX2 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BEARD_HAS_SSE2 1
+#else
+#define BEARD_HAS_SSE2 0
+#endif
+
 #define BEARD_DEBUG 0
 #define BEARD_RELWITHDEBINFO 0
 #define BEARD_RELEASE 0
@@ -72,11 +87,16 @@
 #define BEARD_BREAKPOINT __asm__ volatile("int $0x03")
 #define BEARD_LIKELY(x) __builtin_expect(!!(x), 1)
 #define BEARD_NO_VTABLE
+#define BEARD_PREFETCH(address) __builtin_prefetch(address)
+#define BEARD_TARGET(isa) __attribute__((target(isa)))
 #elif BEARD_COMPILER_MSVC
 #define BEARD_ALIGN(x, a) __declspec(align(a)) x
 #define BEARD_BREAKPOINT __debugbreak()
 #define BEARD_LIKELY(x) (x)
 #define BEARD_NO_VTABLE __declspec(novtable)
+#define BEARD_PREFETCH(address) \
+  _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#define BEARD_TARGET(isa)
 #endif
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
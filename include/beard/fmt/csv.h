@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/fmt/fmt.h"
+#include "beard/misc/optional.h"
+
+namespace beard::fmt {
+// One record of a csv file. The fields point into the reader buffer and are
+// only valid until the next call to csv_reader::next_row.
+class csv_row {
+ public:
+  i32 column_count() const { return m_fields.element_count(); }
+
+  std::string_view operator[](i32 column) const { return m_fields[column]; }
+
+  std::span<const std::string_view> fields() const {
+    return {m_fields.data(), static_cast<usize>(m_fields.element_count())};
+  }
+
+  // Parse a field with parse_number, empty if the column does not exist or
+  // does not hold a number
+  template <typename T>
+  beard::optional<T> get(i32 column) const {
+    if (column < 0 || column >= column_count()) {
+      return {};
+    }
+    return parse_number<T>(m_fields[column]);
+  }
+
+  // Line of the file the record starts on, starting at 1
+  i64 line_number() const { return m_line_number; }
+
+ private:
+  friend class csv_reader;
+
+  beard::array<std::string_view> m_fields;
+  i64 m_line_number = 0;
+};
+
+// Streaming reader for RFC 4180 csv (or tsv with '\t' as delimiter) files.
+// Files are read chunk by chunk in a buffer of fixed size, which only grows
+// when a single record does not fit in it, so memory stays constant whatever
+// the size of the file.
+//
+// Fields are views into the buffer. Quoted fields are returned without their
+// quotes, and only the ones holding escaped quotes ("") are copied to be
+// unescaped, anything between a closing quote and the next delimiter is
+// ignored. Lines may end with "\n" or "\r\n", empty lines are skipped.
+class csv_reader {
+ public:
+  static constexpr usize DEFAULT_CHUNK_SIZE = MB(usize{1});
+
+  explicit csv_reader(char delimiter = ',',
+                      char quote = '"',
+                      usize chunk_size = DEFAULT_CHUNK_SIZE);
+  ~csv_reader();
+
+  NONCOPYABLE(csv_reader);
+  NONMOVEABLE(csv_reader);
+
+  // Stream the file from disk
+  bool open(std::string_view filename);
+
+  // Read from a buffer that is already in memory (read_whole_file, mapped
+  // file, ...), without copying it. The buffer must outlive the reader.
+  void open_from_memory(std::string_view buffer);
+
+  void close();
+
+  // Read the next record in row. Returns false at the end of the input, or
+  // on an error (unterminated quoted field, read error), see has_error.
+  bool next_row(csv_row& row);
+
+  // Read the next record as the header, giving names to the columns
+  bool read_header();
+
+  // Index of the column called name in the header, -1 if there is none
+  i32 column_index(std::string_view name) const;
+
+  const beard::array<std::string>& header() const { return m_header; }
+
+  bool has_error() const { return m_has_error; }
+
+ private:
+  enum class parse_status { complete, incomplete, end, error };
+
+  parse_status parse_row(csv_row& row);
+  void add_field(csv_row& row,
+                 usize start,
+                 usize end,
+                 bool quoted,
+                 bool has_escaped_quotes);
+  bool refill();
+
+  delimiter_set m_special_characters;
+  delimiter_scanner m_scanner;
+  char m_quote;
+  usize m_chunk_size;
+
+  FILE* m_file = nullptr;
+  bool m_is_at_end = true;
+  bool m_has_error = false;
+
+  // Data not consumed yet is m_data.substr(m_position), m_data being the
+  // valid part of m_buffer, or the whole input when reading from memory
+  std::string m_buffer;
+  std::string_view m_data;
+  usize m_position = 0;
+  i64 m_line_number = 1;
+
+  // Storage for the unescaped quoted fields of the current row, and which
+  // fields point to it
+  std::string m_unescaped;
+  beard::array<i32> m_unescaped_fields;
+
+  beard::array<std::string> m_header;
+};
+}  // namespace beard::fmt
@@ -1,46 +1,575 @@
 #pragma once
 
+#include <bit>
 #include <charconv>
+#include <cstring>
+#include <iterator>
+#include <limits>
 #include <optional>
+#include <span>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
 #include "beard/misc/optional.h"
 
 namespace beard::fmt {
-std::vector<std::string_view> tokenize(std::string_view input,
-                                       std::string_view token,
-                                       bool skip_empty = true) {
-  std::vector<std::string_view> result;
+// Set of delimiter characters, classifying whole blocks of text at once with
+// SIMD instructions (picked at runtime, with a scalar fallback).
+class delimiter_set {
+ public:
+  static constexpr usize BLOCK_SIZE = 64;
+
+  explicit delimiter_set(std::string_view delimiters);
+
+  bool contains(char c) const {
+    u8 byte = static_cast<u8>(c);
+    u8 row = byte < 0x80 ? m_low_table[byte & 15] : m_high_table[byte & 15];
+    return (row >> ((byte >> 4) & 7)) & 1;
+  }
+
+  // Bit i of the result is set if block[i] is a delimiter. The block must
+  // hold BLOCK_SIZE readable bytes.
+  u64 match_block(const char* block) const;
+
+  // Same, for a block of less than BLOCK_SIZE bytes
+  u64 match_partial_block(const char* block, usize size) const;
+
+  // Position of the first delimiter at or after from, or npos
+  usize find_first(std::string_view text, usize from = 0) const;
+
+ private:
+  friend struct delimiter_set_kernels;
 
-  auto curr_str = input;
-  usize offset;
-  while ((offset = curr_str.find_first_of(token)) != std::string_view::npos) {
-    if (offset != 0 || !skip_empty) {
-      result.push_back(curr_str.substr(0, offset));
+  // The set is stored as a 256 bits bitmap, rows being indexed by the low
+  // nibble of a character and bits by its high nibble. Characters under 0x80
+  // are in the low table, the others in the high one.
+  alignas(16) u8 m_low_table[16] = {};
+  alignas(16) u8 m_high_table[16] = {};
+  // Comparing against a single character is cheaper than a table lookup
+  char m_single = 0;
+  bool m_is_single = false;
+  // Best implementation for the current CPU
+  u64 (*m_match_block)(const delimiter_set&, const char*) = nullptr;
+};
+
+// Iterates over the positions of the delimiters of a text, classifying it
+// one block at a time
+class delimiter_scanner {
+ public:
+  delimiter_scanner() = default;
+  delimiter_scanner(std::string_view text, const delimiter_set* delimiters)
+      : m_text{text}, m_delimiters{delimiters} {}
+
+  // Position of the next delimiter, or npos when there are no more
+  usize next() {
+    while (m_mask == 0) {
+      if (m_block_start >= m_text.size()) {
+        return std::string_view::npos;
+      }
+
+      m_block_start = m_next_block;
+      usize remaining = m_text.size() - m_block_start;
+      if (remaining >= delimiter_set::BLOCK_SIZE) {
+        m_mask = m_delimiters->match_block(m_text.data() + m_block_start);
+        m_next_block = m_block_start + delimiter_set::BLOCK_SIZE;
+      } else {
+        m_mask = m_delimiters->match_partial_block(
+            m_text.data() + m_block_start, remaining);
+        m_next_block = m_text.size();
+        if (m_mask == 0) {
+          m_block_start = m_text.size();
+        }
+      }
     }
-    curr_str = curr_str.substr(offset + 1);
+
+    usize position = m_block_start + std::countr_zero(m_mask);
+    m_mask &= m_mask - 1;
+    return position;
+  }
+
+ private:
+  std::string_view m_text;
+  const delimiter_set* m_delimiters = nullptr;
+  usize m_block_start = 0;
+  usize m_next_block = 0;
+  u64 m_mask = 0;
+};
+
+// Iterates over the tokens of a string without allocating. Empty tokens are
+// skipped if skip_empty is set, a trailing delimiter never yields an empty
+// token.
+class token_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::string_view;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const std::string_view*;
+  using reference = const std::string_view&;
+
+  // Default constructed iterators are end iterators
+  token_iterator() = default;
+  token_iterator(std::string_view input,
+                 const delimiter_set* delimiters,
+                 bool skip_empty)
+      : m_input{input},
+        m_scanner{input, delimiters},
+        m_skip_empty{skip_empty},
+        m_is_end{false} {
+    advance();
   }
 
-  if (!curr_str.empty()) {
-    result.push_back(curr_str);
+  reference operator*() const { return m_token; }
+  pointer operator->() const { return &m_token; }
+
+  token_iterator& operator++() {
+    advance();
+    return *this;
+  }
+
+  token_iterator operator++(int) {
+    auto result = *this;
+    advance();
+    return result;
+  }
+
+  bool operator==(const token_iterator& other) const {
+    if (m_is_end || other.m_is_end) {
+      return m_is_end == other.m_is_end;
+    }
+    return m_token.data() == other.m_token.data();
+  }
+
+ private:
+  void advance() {
+    while (m_token_start < m_input.size()) {
+      usize position = m_scanner.next();
+      if (position == std::string_view::npos) {
+        m_token = m_input.substr(m_token_start);
+        m_token_start = m_input.size();
+        return;
+      }
+
+      m_token = m_input.substr(m_token_start, position - m_token_start);
+      m_token_start = position + 1;
+      if (!m_token.empty() || !m_skip_empty) {
+        return;
+      }
+    }
+
+    m_is_end = true;
+  }
+
+  std::string_view m_input;
+  std::string_view m_token;
+  usize m_token_start = 0;
+  delimiter_scanner m_scanner;
+  bool m_skip_empty = true;
+  bool m_is_end = true;
+};
+
+// The iterators point to the delimiter set of the range, and must not
+// outlive it
+class token_range {
+ public:
+  token_range(std::string_view input,
+              std::string_view delimiters,
+              bool skip_empty)
+      : m_input{input}, m_delimiters{delimiters}, m_skip_empty{skip_empty} {}
+
+  token_iterator begin() const {
+    return {m_input, &m_delimiters, m_skip_empty};
   }
+  token_iterator end() const { return {}; }
 
+ private:
+  std::string_view m_input;
+  delimiter_set m_delimiters;
+  bool m_skip_empty;
+};
+
+// Lazy version of tokenize, tokens are only looked for when iterating
+inline token_range tokenize_lazy(std::string_view input,
+                                 std::string_view token,
+                                 bool skip_empty = true) {
+  return {input, token, skip_empty};
+}
+
+// Append the tokens to result, which can be reused between calls to avoid
+// allocating once its capacity is big enough
+inline void tokenize(std::string_view input,
+                     std::string_view token,
+                     beard::array<std::string_view>& result,
+                     bool skip_empty = true) {
+  for (auto t : tokenize_lazy(input, token, skip_empty)) {
+    result.add(t);
+  }
+}
+
+inline std::vector<std::string_view> tokenize(std::string_view input,
+                                              std::string_view token,
+                                              bool skip_empty = true) {
+  std::vector<std::string_view> result;
+  for (auto t : tokenize_lazy(input, token, skip_empty)) {
+    result.push_back(t);
+  }
   return result;
 }
 
+class line_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::string_view;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const std::string_view*;
+  using reference = const std::string_view&;
+
+  line_iterator() = default;
+  explicit line_iterator(token_iterator it) : m_it{it} { update(); }
+
+  reference operator*() const { return m_line; }
+  pointer operator->() const { return &m_line; }
+
+  line_iterator& operator++() {
+    ++m_it;
+    update();
+    return *this;
+  }
+
+  line_iterator operator++(int) {
+    auto result = *this;
+    ++*this;
+    return result;
+  }
+
+  bool operator==(const line_iterator& other) const {
+    return m_it == other.m_it;
+  }
+
+ private:
+  void update() {
+    if (m_it != token_iterator{}) {
+      m_line = *m_it;
+      if (!m_line.empty() && m_line.back() == '\r') {
+        m_line.remove_suffix(1);
+      }
+    }
+  }
+
+  token_iterator m_it;
+  std::string_view m_line;
+};
+
+class line_range {
+ public:
+  line_range(std::string_view input, bool skip_empty)
+      : m_tokens{input, "\n", skip_empty} {}
+
+  line_iterator begin() const { return line_iterator{m_tokens.begin()}; }
+  line_iterator end() const { return {}; }
+
+ private:
+  token_range m_tokens;
+};
+
+// Lazily split a text on "\n" or "\r\n". Like tokenize, a trailing new
+// line does not yield an empty last line.
+inline line_range split_lines(std::string_view input, bool skip_empty = false) {
+  return {input, skip_empty};
+}
+
+inline void split_lines(std::string_view input,
+                        beard::array<std::string_view>& result,
+                        bool skip_empty = false) {
+  for (auto line : split_lines(input, skip_empty)) {
+    result.add(line);
+  }
+}
+
+namespace detail {
+// Eisel-Lemire, falling back to std::from_chars for the inputs it cannot
+// decide on (more than 19 digits, inf, nan, ...)
+bool parse_float(std::string_view input, f32* result);
+bool parse_float(std::string_view input, f64* result);
+}  // namespace detail
+
 template <typename T>
 inline beard::optional<T> parse_number(std::string_view input) {
   T result;
-  auto start = input.data();
-  auto end = input.data() + input.size();
-  auto parse_result = std::from_chars(start, end, result);
 
-  if (parse_result.ec != std::errc{}) {
-    return {};
+  if constexpr (std::is_same_v<T, f32> || std::is_same_v<T, f64>) {
+    if (!detail::parse_float(input, &result)) {
+      return {};
+    }
+  } else {
+    auto start = input.data();
+    auto end = input.data() + input.size();
+    auto parse_result = std::from_chars(start, end, result);
+
+    if (parse_result.ec != std::errc{}) {
+      return {};
+    }
   }
 
   return result;
 }
 
+// Large enough for any float or double written by format_number
+constexpr usize FORMAT_NUMBER_BUFFER_SIZE = 32;
+
+// Shortest representation that parses back to the same value, choosing
+// between fixed and scientific notation like std::to_chars(first, last,
+// value). The only difference is that large integers end with zeros instead
+// of their exact digits (2^60 gives 1152921504606847000). Writes to buffer,
+// which must hold at least FORMAT_NUMBER_BUFFER_SIZE chars, and returns the
+// end of the written text. Not null terminated.
+char* format_number(f32 value, char* buffer);
+char* format_number(f64 value, char* buffer);
+
+namespace detail {
+inline u64 load_eight_bytes(const char* p) {
+  u64 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// High bit set in each byte that is not an ascii digit
+inline u64 non_digit_mask(u64 v) {
+  return ((v + 0x4646464646464646ull) | (v - 0x3030303030303030ull)) &
+         0x8080808080808080ull;
+}
+
+// Value of 8 ascii digits loaded in a little endian u64, in a few multiplies
+inline u32 parse_eight_digits(u64 v) {
+  v -= 0x3030303030303030ull;
+  v = (v * 10) + (v >> 8);
+  v = (((v & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) +
+       (((v >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >>
+      32;
+  return static_cast<u32>(v);
+}
+
+static constexpr u64 POWERS_OF_TEN[20] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+static constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Number of decimal digits of value, without a loop: bit_width(value) *
+// log10(2) is either right or one too many, the table tells which. Setting
+// the low bit never changes the count and gives 0 its digit.
+inline i32 count_digits(u64 value) {
+  value |= 1;
+  i32 t = (std::bit_width(value) * 1233) >> 12;
+  return t + 1 - (value < POWERS_OF_TEN[t]);
+}
+
+// Write the digits of value backwards from end, two at a time
+template <typename U>
+inline void write_digits(U value, char* end) {
+  while (value >= 100) {
+    end -= 2;
+    memcpy(end, DIGIT_PAIRS + (value % 100) * 2, 2);
+    value /= 100;
+  }
+
+  if (value >= 10) {
+    memcpy(end - 2, DIGIT_PAIRS + value * 2, 2);
+  } else {
+    end[-1] = static_cast<char>('0' + value);
+  }
+}
+
+inline bool is_number_separator(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+}  // namespace detail
+
+struct parse_numbers_result {
+  i32 parsed_count = 0;
+  // Offset of the first invalid character, npos if everything was parsed
+  usize error_position = std::string_view::npos;
+
+  bool ok() const { return error_position == std::string_view::npos; }
+};
+
+// Parse whitespace separated integers and append them to result, tokenizing
+// and parsing in one pass, 8 digits at a time. Stops at the first error.
+template <typename T>
+parse_numbers_result parse_numbers(std::string_view input,
+                                   beard::array<T>& result) {
+  static_assert(std::is_integral_v<T>, "parse_numbers only parses integers");
+  using unsigned_type = std::make_unsigned_t<T>;
+  constexpr u64 max_value = static_cast<u64>(std::numeric_limits<T>::max());
+
+  parse_numbers_result status;
+  const char* begin = input.data();
+  const char* end = begin + input.size();
+  const char* p = begin;
+
+  for (;;) {
+    while (p < end && detail::is_number_separator(*p)) {
+      ++p;
+    }
+    if (p == end) {
+      return status;
+    }
+
+    const char* token_start = p;
+    bool negative = false;
+    if constexpr (std::is_signed_v<T>) {
+      if (*p == '-') {
+        negative = true;
+        ++p;
+      }
+    }
+
+    const char* digits_start = p;
+    u64 value = 0;
+    while (end - p >= 8) {
+      u64 chunk = detail::load_eight_bytes(p);
+      u64 non_digits = detail::non_digit_mask(chunk);
+      if (non_digits == 0) {
+        value = value * 100000000 + detail::parse_eight_digits(chunk);
+        p += 8;
+        continue;
+      }
+
+      // Keep the leading digits only, padding them with zeros on the left
+      i32 digit_count = std::countr_zero(non_digits) / 8;
+      if (digit_count > 0) {
+        i32 shift = (8 - digit_count) * 8;
+        chunk = (chunk << shift) | (0x3030303030303030ull >> (64 - shift));
+        value = value * detail::POWERS_OF_TEN[digit_count] +
+                detail::parse_eight_digits(chunk);
+        p += digit_count;
+      }
+      break;
+    }
+    while (p < end && static_cast<u8>(*p - '0') < 10) {
+      value = value * 10 + static_cast<u8>(*p - '0');
+      ++p;
+    }
+
+    if (p == digits_start) {
+      status.error_position = p - begin;
+      return status;
+    }
+    if (p < end && !detail::is_number_separator(*p)) {
+      status.error_position = p - begin;
+      return status;
+    }
+
+    // Up to 19 digits always fit in the u64 accumulator, only longer numbers
+    // need from_chars to check for overflows
+    if (p - digits_start > 19) {
+      T checked;
+      auto parsed = std::from_chars(token_start, p, checked);
+      if (parsed.ec != std::errc{}) {
+        status.error_position = token_start - begin;
+        return status;
+      }
+      result.add(checked);
+    } else if (value > max_value + negative) {
+      status.error_position = token_start - begin;
+      return status;
+    } else if (negative) {
+      result.add(static_cast<T>(
+          static_cast<unsigned_type>(0) - static_cast<unsigned_type>(value)));
+    } else {
+      result.add(static_cast<T>(value));
+    }
+    ++status.parsed_count;
+  }
+}
+
+// Longest text format_integer can write for a T
+template <typename T>
+constexpr usize MAX_INTEGER_LENGTH =
+    std::numeric_limits<T>::digits10 + 1 + std::is_signed_v<T>;
+
+// Inverse of parse_number for integers, with the same output as
+// std::to_chars. Writes to buffer, which must hold at least
+// MAX_INTEGER_LENGTH<T> chars, and returns the end of the written text.
+template <typename T>
+inline char* format_integer(T value, char* buffer) {
+  static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                "format_integer expects an integer");
+  using unsigned_type = std::make_unsigned_t<T>;
+
+  auto magnitude = static_cast<unsigned_type>(value);
+  if constexpr (std::is_signed_v<T>) {
+    if (value < 0) {
+      *buffer++ = '-';
+      magnitude = static_cast<unsigned_type>(0) - magnitude;
+    }
+  }
+
+  i32 digit_count = detail::count_digits(magnitude);
+  // Divisions by constants are cheaper on 32 bits
+  if (magnitude <= std::numeric_limits<u32>::max()) {
+    detail::write_digits(static_cast<u32>(magnitude), buffer + digit_count);
+  } else {
+    detail::write_digits(static_cast<u64>(magnitude), buffer + digit_count);
+  }
+  return buffer + digit_count;
+}
+
+// Format a whole column of integers, separated by separator. buffer must
+// hold values.size() * (MAX_INTEGER_LENGTH<T> + separator.size()) chars.
+// Returns the end of the written text.
+template <typename T>
+char* format_integers(std::span<const T> values,
+                      std::string_view separator,
+                      char* buffer) {
+  if (values.empty()) {
+    return buffer;
+  }
+
+  buffer = format_integer(values[0], buffer);
+  if (separator.size() == 1) {
+    char c = separator[0];
+    for (usize i = 1; i < values.size(); ++i) {
+      *buffer++ = c;
+      buffer = format_integer(values[i], buffer);
+    }
+  } else {
+    for (usize i = 1; i < values.size(); ++i) {
+      memcpy(buffer, separator.data(), separator.size());
+      buffer = format_integer(values[i], buffer + separator.size());
+    }
+  }
+  return buffer;
+}
 }  // namespace beard::fmt
\ No newline at end of file
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/fmt/fmt.h"
+#include "beard/misc/optional.h"
+
+namespace beard::fmt {
+class json_document;
+
+enum class json_type { invalid, null, boolean, number, string, array, object };
+
+class json_array_range;
+class json_object_range;
+
+// Handle to a value of a json_document, only valid as long as the document
+// (and its text) is. Nothing is parsed until asked for: numbers are parsed
+// with parse_number when calling get_number, strings are views into the
+// text. Accessing a missing field or a value of the wrong type gives an
+// empty optional, or an invalid value that can still be used (as in
+// doc.root()["a"]["b"]) and stays invalid.
+class json_value {
+ public:
+  json_value() = default;
+  json_value(const json_document* document, u32 index)
+      : m_document{document}, m_index{index} {}
+
+  json_type type() const;
+  bool is_valid() const { return type() != json_type::invalid; }
+  bool is_null() const { return type() == json_type::null; }
+
+  beard::optional<bool> get_bool() const;
+
+  template <typename T>
+  beard::optional<T> get_number() const {
+    if (type() != json_type::number) {
+      return {};
+    }
+    return parse_number<T>(raw());
+  }
+
+  // Contents of the string as they are in the text, escape sequences
+  // included. Enough for most keys and values, and never copies.
+  beard::optional<std::string_view> get_raw_string() const;
+
+  // Contents of the string with escape sequences decoded, replacing output
+  bool get_string(std::string& output) const;
+
+  // Text of the value, as it is in the input (whole containers included)
+  std::string_view raw() const;
+
+  // Value of the field of an object. Keys are compared with their raw text.
+  json_value operator[](std::string_view key) const;
+
+  // Element of an array, walking the elements before it
+  json_value at(i32 index) const;
+
+  // Empty ranges if the value is not an array (or an object)
+  json_array_range elements() const;
+  json_object_range fields() const;
+
+ private:
+  friend class json_array_iterator;
+  friend class json_object_iterator;
+
+  char first_char() const;
+
+  const json_document* m_document = nullptr;
+  u32 m_index = 0;
+};
+
+struct json_field {
+  std::string_view key;  // Raw, escape sequences included
+  json_value value;
+};
+
+class json_array_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = json_value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const json_value*;
+  using reference = json_value;
+
+  json_array_iterator() = default;
+  json_array_iterator(const json_document* document,
+                      u32 index,
+                      bool is_top_level = false)
+      : m_document{document}, m_index{index}, m_is_top_level{is_top_level} {}
+
+  json_value operator*() const { return {m_document, m_index}; }
+
+  json_array_iterator& operator++();
+
+  bool operator==(const json_array_iterator& other) const {
+    return m_index == other.m_index;
+  }
+
+ private:
+  const json_document* m_document = nullptr;
+  u32 m_index = END;
+  // Top level values follow each other without commas
+  bool m_is_top_level = false;
+
+ public:
+  static constexpr u32 END = ~u32{0};
+};
+
+class json_object_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = json_field;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const json_field*;
+  using reference = json_field;
+
+  json_object_iterator() = default;
+  json_object_iterator(const json_document* document, u32 index);
+
+  json_field operator*() const;
+
+  json_object_iterator& operator++();
+
+  bool operator==(const json_object_iterator& other) const {
+    return m_index == other.m_index;
+  }
+
+ private:
+  void check_field();
+
+  const json_document* m_document = nullptr;
+  u32 m_index = json_array_iterator::END;
+};
+
+class json_array_range {
+ public:
+  json_array_range() = default;
+  json_array_range(json_array_iterator begin) : m_begin{begin} {}
+
+  json_array_iterator begin() const { return m_begin; }
+  json_array_iterator end() const { return {}; }
+
+ private:
+  json_array_iterator m_begin;
+};
+
+class json_object_range {
+ public:
+  json_object_range() = default;
+  json_object_range(json_object_iterator begin) : m_begin{begin} {}
+
+  json_object_iterator begin() const { return m_begin; }
+  json_object_iterator end() const { return {}; }
+
+ private:
+  json_object_iterator m_begin;
+};
+
+// JSON text indexed for on-demand access, without building a tree. Parsing
+// only finds the positions of the structural characters ({}[]:, and the
+// start of every value) in the text, 64 bytes at a time with SIMD
+// instructions, skipping what is inside strings. Values are only looked at
+// when accessed, so malformed values are only noticed then.
+//
+// The text must outlive the document. A document can be reused to parse
+// other texts, which only allocates when a text needs a bigger index.
+class json_document {
+ public:
+  json_document() = default;
+  ~json_document() = default;
+
+  NONCOPYABLE(json_document);
+  DEFAULT_MOVEABLE(json_document);
+
+  // Index text, returns false if it holds an unterminated string. Texts
+  // must be smaller than 4GB.
+  bool parse(std::string_view text);
+
+  // First value of the text
+  json_value root() const;
+
+  // Every top level value of the text, as in newline delimited json
+  json_array_range values() const;
+
+  std::string_view text() const { return m_text; }
+
+ private:
+  friend class json_value;
+  friend class json_array_iterator;
+  friend class json_object_iterator;
+
+  char char_at(u32 index) const {
+    return index < m_structural_count ? m_text[m_structurals[index]] : '\0';
+  }
+
+  // Index of the structural following the value starting at index
+  u32 skip_value(u32 index) const;
+
+  // Raw text of the key of the field starting at index
+  std::string_view key_at(u32 index) const;
+
+  std::string_view m_text;
+  // Positions of the structurals, followed by m_text.size() as a sentinel
+  beard::array<u32> m_structurals;
+  u32 m_structural_count = 0;
+};
+
+// Iterates over the documents of newline delimited json, indexing the text
+// one batch of lines at a time so that the index stays small whatever the
+// size of the text.
+class ndjson_reader {
+ public:
+  static constexpr usize DEFAULT_BATCH_SIZE = MB(usize{1});
+
+  explicit ndjson_reader(std::string_view text,
+                         usize batch_size = DEFAULT_BATCH_SIZE)
+      : m_text{text}, m_batch_size{batch_size} {}
+
+  NONCOPYABLE(ndjson_reader);
+  NONMOVEABLE(ndjson_reader);
+
+  // Next document, only valid until the next call. Returns false at the end
+  // of the text or on an error, see has_error.
+  bool next(json_value& value);
+
+  bool has_error() const { return m_has_error; }
+
+ private:
+  std::string_view m_text;
+  usize m_batch_size;
+  usize m_position = 0;
+  bool m_has_error = false;
+
+  json_document m_document;
+  json_array_iterator m_current;
+};
+}  // namespace beard::fmt
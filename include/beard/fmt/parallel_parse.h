@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string_view>
+#include <type_traits>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/thread_pool.h"
+
+namespace beard::fmt {
+// Split text in at most chunk_count chunks of about the same size, each one
+// ending right after a new line (except the last one) so that no record is
+// cut in two. When quote is not '\0', new lines between quotes are not
+// record boundaries, as in csv files. Chunks are never empty.
+beard::array<std::string_view> split_records(
+    std::string_view text,
+    i32 chunk_count,
+    char quote = '\0',
+    thread_pool& pool = thread_pool::shared());
+
+// Chunks smaller than this are not worth a task of their own
+constexpr usize MINIMUM_PARALLEL_CHUNK_SIZE = KB(usize{256});
+
+// Split text with split_records and call parse_chunk(chunk) on every chunk
+// concurrently. Returns what each call returned, in the order of the chunks,
+// so that concatenating them gives the same result as parsing the whole text
+// at once.
+template <typename Fn>
+auto parse_parallel(std::string_view text,
+                    Fn&& parse_chunk,
+                    char quote = '\0',
+                    thread_pool& pool = thread_pool::shared()) {
+  using result_type = std::invoke_result_t<Fn&, std::string_view>;
+
+  // A few chunks per thread, so that uneven chunks still keep every thread
+  // busy until the end
+  i32 chunk_count = pool.thread_count() * 4;
+  usize max_chunk_count = text.size() / MINIMUM_PARALLEL_CHUNK_SIZE + 1;
+  if (static_cast<usize>(chunk_count) > max_chunk_count) {
+    chunk_count = static_cast<i32>(max_chunk_count);
+  }
+
+  auto chunks = split_records(text, chunk_count, quote, pool);
+
+  beard::array<result_type> results;
+  results.resize(chunks.element_count());
+  pool.parallel_for(chunks.element_count(),
+                    [&](i32 i) { results[i] = parse_chunk(chunks[i]); });
+  return results;
+}
+}  // namespace beard::fmt
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "beard/core/macros.h"
+#include "beard/fmt/fmt.h"
+#include "beard/io/io.h"
+
+namespace beard::fmt {
+// Growable text buffer to assemble output without temporary strings. The
+// first INLINE_SIZE bytes live in the builder itself, and reset() keeps the
+// memory, so a builder reused across records stops allocating once it has
+// grown to the size of the largest one.
+class string_builder {
+ public:
+  static constexpr usize INLINE_SIZE = 512;
+
+  string_builder() = default;
+  explicit string_builder(usize capacity) { m_buffer.reserve(capacity); }
+  ~string_builder() = default;
+
+  NONCOPYABLE(string_builder);
+  DEFAULT_MOVEABLE(string_builder);
+
+  // Same as fmt::format, appending to the builder
+  template <typename... Args>
+  void format(::fmt::format_string<Args...> pattern, Args&&... args) {
+    ::fmt::format_to(out(), pattern, std::forward<Args>(args)...);
+  }
+
+  // Output iterator for fmt::format_to and friends, writing straight into
+  // the buffer
+  auto out() { return std::back_inserter(m_buffer); }
+
+  void append(std::string_view text) {
+    m_buffer.append(text.data(), text.data() + text.size());
+  }
+
+  void append(char c) { m_buffer.push_back(c); }
+
+  // Integers with format_integer, floating point numbers with format_number
+  template <typename T>
+  void append_number(T value) {
+    static_assert(std::is_arithmetic_v<T>, "append_number expects a number");
+
+    usize size = m_buffer.size();
+    m_buffer.resize(size + FORMAT_NUMBER_BUFFER_SIZE);
+    char* start = m_buffer.data() + size;
+    char* end;
+    if constexpr (std::is_floating_point_v<T>) {
+      end = format_number(value, start);
+    } else {
+      end = format_integer(value, start);
+    }
+    m_buffer.resize(size + (end - start));
+  }
+
+  // Append a column of integers, separated by separator
+  template <typename T>
+  void append_integers(std::span<const T> values, std::string_view separator) {
+    usize size = m_buffer.size();
+    m_buffer.resize(size +
+                    values.size() * (MAX_INTEGER_LENGTH<T> + separator.size()));
+    char* start = m_buffer.data() + size;
+    char* end = format_integers(values, separator, start);
+    m_buffer.resize(size + (end - start));
+  }
+
+  // Empty the builder, keeping its memory for the next use
+  void reset() { m_buffer.clear(); }
+
+  void reserve(usize capacity) { m_buffer.reserve(capacity); }
+
+  const char* data() const { return m_buffer.data(); }
+  usize size() const { return m_buffer.size(); }
+  usize capacity() const { return m_buffer.capacity(); }
+  bool is_empty() const { return m_buffer.size() == 0; }
+
+  // Valid until the next modification of the builder
+  std::string_view view() const { return {m_buffer.data(), m_buffer.size()}; }
+
+  std::string to_string() const { return std::string{view()}; }
+
+  // Hand the contents to the file, without an intermediate string
+  bool write_to_file(std::string_view filename) const {
+    return io::write_whole_file(filename, view());
+  }
+
+ private:
+  ::fmt::basic_memory_buffer<char, INLINE_SIZE> m_buffer;
+};
+}  // namespace beard::fmt
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string_view>
+
+#include "beard/core/macros.h"
+
+namespace beard::fmt {
+// Whether text is valid UTF-8: no truncated sequences, overlong encodings,
+// surrogates or code points above U+10FFFF. Uses AVX2 when the CPU has it.
+bool is_valid_utf8(std::string_view text);
+
+struct utf_conversion_result {
+  // Number of code units written to the output
+  usize written_count = 0;
+  // Offset of the first invalid code unit of the input, npos if none
+  usize error_position = std::string_view::npos;
+
+  bool ok() const { return error_position == std::string_view::npos; }
+};
+
+// Size of the output of the conversions below, for valid inputs
+usize utf32_length_from_utf8(std::string_view text);
+usize utf8_length_from_utf32(std::u32string_view text);
+
+// Decode text into output, which must have room for
+// utf32_length_from_utf8(text) code points (text.size() is always enough).
+// Stops at the first invalid sequence, what was decoded before it is kept.
+utf_conversion_result utf8_to_utf32(std::string_view text, char32_t* output);
+
+// Encode text into output, which must have room for
+// utf8_length_from_utf32(text) bytes (4 * text.size() is always enough).
+// Stops at the first surrogate or code point above U+10FFFF.
+utf_conversion_result utf32_to_utf8(std::u32string_view text, char* output);
+}  // namespace beard::fmt
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/thread_pool.h"
+
+namespace beard::io {
+struct read_result {
+  // Number of bytes read, less than the size of the buffer when the file
+  // ends before it is full
+  usize size = 0;
+  // errno value of the failed open or read, 0 on success
+  i32 error = 0;
+
+  bool ok() const { return error == 0; }
+};
+
+using read_callback = std::function<void(const read_result&)>;
+
+namespace detail {
+struct io_ring;
+struct read_request;
+}  // namespace detail
+
+// Reads files asynchronously into buffers owned by the caller. On Linux the
+// open, read and close of every file go through io_uring, batched so that
+// many reads cost a handful of syscalls. Elsewhere, or when the kernel does
+// not support it, each read runs as a blocking task of a thread pool. Reads
+// also move to the pool if io_uring stops working.
+//
+// Callbacks are called from a background thread (the io_uring completion
+// thread or a worker of the pool) and should be short. Buffers must stay
+// valid until the callback was called or the future is ready.
+class async_reader {
+ public:
+  static constexpr u32 DEFAULT_QUEUE_DEPTH = 256;
+
+  // queue_depth is the number of operations in flight with io_uring,
+  // fallback_pool runs the reads otherwise
+  explicit async_reader(u32 queue_depth = DEFAULT_QUEUE_DEPTH,
+                        thread_pool& fallback_pool = thread_pool::shared());
+  // Waits for the reads in flight
+  ~async_reader();
+
+  NONCOPYABLE(async_reader);
+  NONMOVEABLE(async_reader);
+
+  // Read up to buffer.size() bytes of the file from offset into buffer
+  void read(std::string_view filename,
+            std::span<char> buffer,
+            read_callback callback,
+            u64 offset = 0);
+
+  std::future<read_result> read(std::string_view filename,
+                                std::span<char> buffer,
+                                u64 offset = 0);
+
+  // Block until every read submitted so far has completed
+  void wait();
+
+  bool is_using_io_uring() const { return m_ring != nullptr; }
+
+ private:
+  void run_ring();
+  void read_blocking_in_pool(detail::read_request* request);
+  void complete(detail::read_request* request, const read_result& result);
+
+  thread_pool& m_fallback_pool;
+
+  std::mutex m_mutex;
+  std::condition_variable m_is_idle;
+  i64 m_active_count = 0;
+
+  // io_uring state, the queue of requests not submitted yet is shared with
+  // the completion thread, the rest is only used by it
+  std::unique_ptr<detail::io_ring> m_ring;
+  std::deque<detail::read_request*> m_queued;
+  bool m_is_stopping = false;
+  // Set when the ring stopped working, the pool runs every read from then on
+  bool m_has_ring_failed = false;
+  std::thread m_ring_thread;
+};
+
+// Contents of files loaded together by read_many_files, all in one buffer
+class file_batch {
+ public:
+  file_batch() = default;
+  ~file_batch() = default;
+
+  NONCOPYABLE(file_batch);
+  DEFAULT_MOVEABLE(file_batch);
+
+  i32 file_count() const { return m_contents.element_count(); }
+
+  // Contents of the file at index in the list of paths, empty on error.
+  // Valid as long as the batch is.
+  std::string_view operator[](i32 index) const { return m_contents[index]; }
+
+  // errno value of the failed stat, open or read of the file, 0 on success
+  i32 error(i32 index) const { return m_errors[index]; }
+
+  bool has_errors() const;
+
+ private:
+  friend file_batch read_many_files(std::span<const std::string_view> paths,
+                                    async_reader& reader);
+
+  std::unique_ptr<char[]> m_buffer;
+  beard::array<std::string_view> m_contents;
+  beard::array<i32> m_errors;
+};
+
+// Load whole files at once: their sizes are queried first (in parallel on
+// the shared thread pool), then they are all read concurrently with reader,
+// into slices of a single allocation. A file that grew since it was stated
+// is truncated to the size it had then.
+file_batch read_many_files(std::span<const std::string_view> paths,
+                           async_reader& reader);
+
+// Same with a reader created for the batch
+file_batch read_many_files(std::span<const std::string_view> paths);
+}  // namespace beard::io
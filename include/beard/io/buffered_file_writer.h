@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <span>
+#include <string_view>
+
+#include "beard/core/macros.h"
+
+namespace beard::io {
+enum class write_mode { truncate, append };
+
+// Writer collecting small writes in a large buffer, so that appending many
+// small records costs a syscall per buffer instead of one per record.
+// Writes that do not fit in the buffer are sent along with it in a single
+// vectored write, without being copied.
+//
+// With direct I/O (O_DIRECT on Linux) the data skips the page cache, which
+// keeps big sequential outputs from evicting everything else. Writes are
+// then always copied to the buffer, whose size is rounded up to a multiple
+// of DIRECT_IO_ALIGNMENT. File systems that do not support it fall back to
+// buffered writes.
+class buffered_file_writer {
+ public:
+  static constexpr usize DEFAULT_BUFFER_SIZE = MB(usize{1});
+  static constexpr usize DIRECT_IO_ALIGNMENT = KB(usize{4});
+
+  explicit buffered_file_writer(usize buffer_size = DEFAULT_BUFFER_SIZE);
+  ~buffered_file_writer();
+
+  NONCOPYABLE(buffered_file_writer);
+  NONMOVEABLE(buffered_file_writer);
+
+  bool open(std::string_view filename,
+            write_mode mode = write_mode::truncate,
+            bool use_direct_io = false);
+
+  // Flush and close the file, false if any write failed
+  bool close();
+
+  bool write(std::string_view data);
+
+  // Write several pieces at once, as a single vectored write when they do
+  // not fit in the buffer
+  bool write(std::span<const std::string_view> pieces);
+
+  // Hand the buffer to the operating system. With direct I/O, a partial
+  // block at the end stays in the buffer.
+  bool flush();
+
+  // Flush everything, and wait for the data to reach the disk. With direct
+  // I/O, a partial block at the end can only be written without it, so the
+  // writer switches to buffered writes.
+  bool sync();
+
+  bool is_open() const { return m_fd >= 0; }
+  bool has_error() const { return m_has_error; }
+  bool is_using_direct_io() const { return m_is_direct; }
+
+  // Bytes written since open, buffered ones included
+  u64 size() const { return m_written_size + m_buffer_size; }
+
+ private:
+  struct aligned_delete {
+    void operator()(char* p) const {
+      ::operator delete[](p, std::align_val_t{DIRECT_IO_ALIGNMENT});
+    }
+  };
+
+  bool write_pieces(std::span<const std::string_view> pieces);
+  bool flush_direct(bool write_partial_block);
+
+  std::unique_ptr<char[], aligned_delete> m_buffer;
+  usize m_buffer_capacity;
+  usize m_buffer_size = 0;
+
+  i32 m_fd = -1;
+  u64 m_written_size = 0;
+  bool m_is_direct = false;
+  bool m_has_error = false;
+};
+}  // namespace beard::io
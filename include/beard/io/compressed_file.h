@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "beard/core/macros.h"
+#include "beard/io/buffered_file_writer.h"
+#include "beard/io/compression.h"
+#include "beard/io/file_stream_reader.h"
+
+namespace beard::io {
+// Writes a compression frame, compressing a block each time block_size bytes
+// were written. The file can be read back with decompress, or streamed with
+// compressed_file_reader.
+class compressed_file_writer {
+ public:
+  explicit compressed_file_writer(
+      compression_level level = compression_level::fast,
+      usize block_size = compression_frame::DEFAULT_BLOCK_SIZE);
+  ~compressed_file_writer();
+
+  NONCOPYABLE(compressed_file_writer);
+  NONMOVEABLE(compressed_file_writer);
+
+  bool open(std::string_view filename);
+
+  // Compress what is left and end the frame, false if any write failed
+  bool close();
+
+  bool write(std::string_view data);
+
+  bool is_open() const { return m_file.is_open(); }
+  bool has_error() const { return m_has_error || m_file.has_error(); }
+
+  // Bytes written since open, before compression
+  u64 size() const { return m_size; }
+
+ private:
+  bool write_block();
+
+  buffered_file_writer m_file;
+  block_compressor m_compressor;
+  compression_level m_level;
+  usize m_block_size;
+  std::string m_block;
+  std::string m_compressed;
+  u64 m_size = 0;
+  bool m_has_error = false;
+};
+
+// Streams a compressed file a block at a time, decompressing each block as
+// it is read by a file_stream_reader. The chunks follow the same rules as
+// file_stream_reader::next_chunk, carried over tails included.
+class compressed_file_reader {
+ public:
+  explicit compressed_file_reader(
+      usize read_size = file_stream_reader::DEFAULT_CHUNK_SIZE);
+  ~compressed_file_reader() = default;
+
+  NONCOPYABLE(compressed_file_reader);
+  NONMOVEABLE(compressed_file_reader);
+
+  // False if the file could not be opened or is not a compression frame
+  bool open(std::string_view filename);
+  void close();
+
+  std::span<const char> next_chunk(usize carry_over = 0);
+
+  // Whether a read failed or the frame is corrupted, the chunks stop there
+  bool has_error() const { return m_has_error || m_reader.has_error(); }
+
+ private:
+  // Make sure that m_input holds at least size bytes
+  bool fill(usize size);
+  std::span<const char> fail();
+
+  file_stream_reader m_reader;
+  std::span<const char> m_input;
+  usize m_block_size = 0;
+
+  std::unique_ptr<char[]> m_output;
+  usize m_output_capacity = 0;
+  std::span<const char> m_chunk;
+  bool m_is_at_end = true;
+  bool m_has_error = false;
+};
+}  // namespace beard::io
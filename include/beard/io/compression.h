@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "beard/core/macros.h"
+#include "beard/misc/optional.h"
+
+namespace beard::io {
+// LZ77 codec using the LZ4 block format: sequences of literals followed by a
+// match of at least 4 bytes in the previous 64KB. Decompression is a few
+// branches and wide copies per sequence, which runs at several GB/s.
+enum class compression_level {
+  // Greedy matching, taking the first long enough match
+  fast,
+  // Lazy matching over longer hash chains, slower but smaller
+  high,
+};
+
+// Largest possible compressed size of size bytes
+constexpr usize compress_bound(usize size) { return size + size / 255 + 16; }
+
+// Reusable state of the compressor, to avoid allocating and clearing its
+// tables for every block
+class block_compressor {
+ public:
+  block_compressor();
+  ~block_compressor();
+
+  NONCOPYABLE(block_compressor);
+  DEFAULT_MOVEABLE(block_compressor);
+
+  // Compress input to output, which must hold compress_bound(input.size())
+  // bytes. Returns the compressed size.
+  usize compress(std::span<const char> input,
+                 std::span<char> output,
+                 compression_level level = compression_level::fast);
+
+ private:
+  std::unique_ptr<i32[]> m_heads;
+  std::unique_ptr<u16[]> m_chains;
+};
+
+usize compress_block(std::span<const char> input,
+                     std::span<char> output,
+                     compression_level level = compression_level::fast);
+
+// Decompress a block to output, which must be large enough for all of it.
+// Returns the decompressed size, empty if the block is corrupted or does not
+// fit. Never reads or writes out of the spans.
+beard::optional<usize> decompress_block(std::span<const char> input,
+                                        std::span<char> output);
+
+// Frames split the data in independent blocks, each with its compressed and
+// decompressed sizes, so that they can be streamed. Blocks that do not
+// compress are stored as is.
+namespace compression_frame {
+// "BRLZ"
+constexpr u32 MAGIC = 0x5a4c5242;
+constexpr usize DEFAULT_BLOCK_SIZE = KB(usize{256});
+constexpr usize MAX_BLOCK_SIZE = MB(usize{64});
+constexpr u32 STORED_FLAG = 0x80000000;
+
+struct header {
+  u32 magic;
+  u32 block_size;
+};
+
+// Followed by stored_size bytes, the last block is all zeroes
+struct block_header {
+  u32 stored_size;  // | STORED_FLAG when the block is not compressed
+  u32 size;
+};
+}  // namespace compression_frame
+
+std::string compress(std::string_view data,
+                     compression_level level = compression_level::fast,
+                     usize block_size = compression_frame::DEFAULT_BLOCK_SIZE);
+
+// Empty if frame is not a valid frame
+beard::optional<std::string> decompress(std::string_view frame);
+}  // namespace beard::io
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/arena.h"
+#include "beard/misc/thread_pool.h"
+
+namespace beard::io {
+struct directory_entry {
+  // root/relative/path, null terminated, stored in the listing
+  std::string_view path;
+  u64 size;
+  // Same clock as std::filesystem::last_write_time
+  i64 write_time;
+
+  std::string_view name() const {
+    return path.substr(path.find_last_of('/') + 1);
+  }
+  std::string_view extension() const;
+};
+
+struct scan_options {
+  // Keep only files with one of these extensions ("png", ".png", compared
+  // ignoring ASCII case), all of them when empty
+  beard::array<std::string> extensions;
+
+  // Keep only files whose name matches this pattern, where * matches any
+  // sequence of characters and ? any character. Empty matches everything.
+  std::string pattern;
+
+  // Skip the files and directories starting with a dot
+  bool skip_hidden = false;
+
+  // Fill size and write_time, which costs a stat per file
+  bool stat_files = true;
+};
+
+// Regular files found under a directory, in no particular order. The paths
+// live in arenas owned by the listing.
+class directory_listing {
+ public:
+  directory_listing() = default;
+  ~directory_listing() = default;
+
+  NONCOPYABLE(directory_listing);
+  DEFAULT_MOVEABLE(directory_listing);
+
+  i32 entry_count() const { return m_entries.element_count(); }
+  const directory_entry& operator[](i32 index) const {
+    return m_entries[index];
+  }
+
+  auto begin() const { return m_entries.begin(); }
+  auto end() const { return m_entries.end(); }
+
+  // Directories that could not be read, the root included
+  i32 error_count() const { return m_error_count; }
+
+  // Sort the entries by path, for reproducible outputs
+  void sort();
+
+ private:
+  friend directory_listing scan_directory(std::string_view,
+                                          const scan_options&,
+                                          thread_pool&);
+
+  beard::array<directory_entry> m_entries;
+  beard::array<arena> m_arenas;
+  i32 m_error_count = 0;
+};
+
+// Walk the tree under root. On Linux, directories are read with getdents64
+// and files stated relative to their directory, and subdirectories are
+// spread over the pool as they are found. Symbolic links are listed when
+// they point to a regular file, never followed into directories.
+directory_listing scan_directory(std::string_view root,
+                                 const scan_options& options = {},
+                                 thread_pool& pool = thread_pool::shared());
+
+// Whether name matches pattern, see scan_options::pattern
+bool match_pattern(std::string_view name, std::string_view pattern);
+}  // namespace beard::io
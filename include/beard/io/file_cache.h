@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "beard/containers/hash_map.h"
+#include "beard/core/macros.h"
+#include "beard/io/io.h"
+#include "beard/misc/optional.h"
+
+namespace beard::io {
+// Cache of artifacts derived from input files (imported assets, compiled
+// shaders, ...), reused as long as the content of the input is the same.
+//
+// Each input is recorded with its size, write time and a 64 bits hash of
+// its content. A file whose size and write time did not change is only
+// trusted without reading it when its write time is older than the moment
+// it was recorded: otherwise (a file written again within the timestamp
+// granularity, a clock in the future) its content is hashed. A file that
+// was touched but not modified is hashed once, found unchanged, and its new
+// write time recorded.
+//
+// The index and the artifacts live in directory, the index is only written
+// by save (or the destructor).
+class file_cache {
+ public:
+  explicit file_cache(std::string_view directory);
+  // Saves the index if it changed
+  ~file_cache();
+
+  NONCOPYABLE(file_cache);
+  NONMOVEABLE(file_cache);
+
+  // Load the index saved in the directory, false if there is none or it is
+  // not valid, which leaves the cache empty
+  bool load();
+  bool save();
+
+  // Artifact stored for path, empty if the file changed since (or was never
+  // stored)
+  beard::optional<std::string> find(std::string_view path);
+
+  // Record the current state of path along with the artifact derived from it
+  bool store(std::string_view path, std::string_view artifact);
+
+  // Artifact of path, built by build(content) when the file changed
+  template <typename Fn>
+  beard::optional<std::string> find_or_build(std::string_view path,
+                                             Fn&& build);
+
+  // Forget about path and delete its artifact
+  void remove(std::string_view path);
+
+  i32 entry_count() const { return m_entries.element_count(); }
+
+ private:
+  struct entry {
+    u64 size = 0;
+    i64 write_time = 0;
+    // When the entry was recorded, in the same clock as write_time
+    i64 record_time = 0;
+    u64 content_hash = 0;
+  };
+
+  struct file_state {
+    u64 size = 0;
+    i64 write_time = 0;
+  };
+
+  static beard::optional<file_state> stat_file(std::string_view path);
+
+  // Whether the file is the one recorded in entry, reading it only when
+  // needed
+  bool is_unchanged(std::string_view path, entry& recorded);
+
+  // The state must be taken before reading the content, so that a write in
+  // between is noticed next time
+  bool store(std::string_view path,
+             const file_state& state,
+             std::string_view content,
+             std::string_view artifact);
+
+  std::string artifact_path(std::string_view path) const;
+
+  std::string m_directory;
+  string_hash_map<entry> m_entries;
+  bool m_is_dirty = false;
+};
+
+template <typename Fn>
+beard::optional<std::string> file_cache::find_or_build(std::string_view path,
+                                                       Fn&& build) {
+  auto artifact = find(path);
+  if (artifact.has_value()) {
+    return artifact;
+  }
+
+  auto state = stat_file(path);
+  if (!state.has_value()) {
+    return {};
+  }
+  std::string content = read_whole_file(path);
+  std::string built = build(std::as_const(content));
+  if (!store(path, state.value(), content, built)) {
+    return {};
+  }
+  return built;
+}
+}  // namespace beard::io
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+
+namespace beard::io {
+// Sequential reader for files of any size, memory stays at buffer_count
+// chunks. A background thread reads the next chunks ahead into rotating
+// buffers while the current one is processed, and the kernel is told that
+// the file is read sequentially.
+//
+// Parsers that stop in the middle of a record pass the size of that
+// unfinished tail to the next call to next_chunk, which returns it again in
+// front of the new data:
+//
+//   file_stream_reader reader;
+//   reader.open("huge.csv");
+//   usize carry_over = 0;
+//   for (auto chunk = reader.next_chunk(); !chunk.empty();
+//        chunk = reader.next_chunk(carry_over)) {
+//     usize consumed = parse_whole_records(chunk);
+//     carry_over = chunk.size() - consumed;
+//   }
+class file_stream_reader {
+ public:
+  static constexpr usize DEFAULT_CHUNK_SIZE = MB(usize{4});
+  static constexpr i32 DEFAULT_BUFFER_COUNT = 3;
+
+  // Tails up to a quarter of a chunk are carried over for free, longer ones
+  // are copied along with the next chunk
+  explicit file_stream_reader(usize chunk_size = DEFAULT_CHUNK_SIZE,
+                              i32 buffer_count = DEFAULT_BUFFER_COUNT);
+  ~file_stream_reader();
+
+  NONCOPYABLE(file_stream_reader);
+  NONMOVEABLE(file_stream_reader);
+
+  bool open(std::string_view filename);
+  void close();
+
+  // Next chunk of the file, starting with the last carry_over bytes of the
+  // previous one. Valid until the next call. At the end of the file, a
+  // carried over tail is returned alone once, then chunks are empty.
+  std::span<const char> next_chunk(usize carry_over = 0);
+
+  // Whether a read failed, the chunks stop at the failure
+  bool has_error() const { return m_has_error; }
+
+  usize chunk_size() const { return m_chunk_size; }
+
+ private:
+  struct chunk_buffer {
+    std::unique_ptr<char[]> memory;
+    usize size = 0;
+  };
+
+  void read_ahead();
+
+  usize m_chunk_size;
+  usize m_carry_over_capacity;
+
+  FILE* m_file = nullptr;
+  std::thread m_thread;
+
+  // Buffers filled by the thread wait in m_filled, in file order, until the
+  // consumer takes them. It gives them back through m_free.
+  beard::array<chunk_buffer> m_buffers;
+  std::mutex m_mutex;
+  std::condition_variable m_has_filled;
+  std::condition_variable m_has_free;
+  std::deque<i32> m_filled;
+  std::deque<i32> m_free;
+  bool m_is_reading_done = false;
+  bool m_is_stopping = false;
+  bool m_has_error = false;
+
+  // Chunk returned by the last call, in a buffer or in m_long_carry_over
+  // when the carried over tail did not fit in front of a buffer
+  i32 m_current = -1;
+  std::span<const char> m_chunk;
+  std::string m_long_carry_over;
+  bool m_is_at_end = true;
+};
+}  // namespace beard::io
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/optional.h"
+
+namespace beard::io {
+// Zigzag maps signed integers to unsigned ones so that small magnitudes stay
+// small: 0, -1, 1, -2, 2 become 0, 1, 2, 3, 4
+constexpr u32 zigzag_encode(i32 value) {
+  return (static_cast<u32>(value) << 1) ^ static_cast<u32>(value >> 31);
+}
+constexpr u64 zigzag_encode(i64 value) {
+  return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+}
+constexpr i32 zigzag_decode(u32 value) {
+  return static_cast<i32>((value >> 1) ^ (0u - (value & 1)));
+}
+constexpr i64 zigzag_decode(u64 value) {
+  return static_cast<i64>((value >> 1) ^ (u64{0} - (value & 1)));
+}
+
+// Differences to the previous value in place, the first value is kept. The
+// arithmetic wraps, so that any sequence round trips, sorted ones give small
+// values.
+void delta_encode(std::span<u32> values);
+void delta_encode(std::span<u64> values);
+void delta_decode(std::span<u32> values);
+void delta_decode(std::span<u64> values);
+
+// LEB128: 7 bits per byte, the high bit set on all but the last byte
+constexpr usize MAX_VARINT_SIZE = 10;
+
+// Returns the number of bytes written, at most MAX_VARINT_SIZE
+usize write_varint(u64 value, char* output);
+
+// Read the varint at the front of input and remove it from input. Empty if
+// it is truncated or does not fit in 64 bits.
+beard::optional<u64> read_varint(std::string_view& input);
+
+// Append values to output, one varint each
+void encode_varints(std::span<const u32> values, std::string& output);
+void encode_varints(std::span<const u64> values, std::string& output);
+
+// Decode varints until the end of input into values, replacing its content.
+// False if a varint is truncated or too large for the type. Runs of one byte
+// varints are widened 32 at a time with AVX2 when the CPU has it.
+bool decode_varints(std::string_view input, beard::array<u32>& values);
+bool decode_varints(std::string_view input, beard::array<u64>& values);
+
+// Frame of reference bit-packing. The values are cut in blocks, each stored
+// as its minimum and the differences to it over as few bits as the largest
+// one needs. Sorted values are better packed as deltas.
+namespace bit_packing {
+// 32 values for each of the 8 lanes of an AVX2 register. Value i of a block
+// is in lane i % 8, so that unpacking gives the values in order.
+constexpr usize BLOCK_SIZE = 256;
+constexpr usize LANE_COUNT = 8;
+
+enum class mode : u8 {
+  plain,
+  delta,
+};
+
+// The stream starts with the value count as a varint and the mode, then for
+// deltas the first value as a varint. Each block follows, with its header and
+// bit_count * 32 bytes of packed words.
+struct block_header {
+  u32 reference;
+  u32 bit_count;
+};
+}  // namespace bit_packing
+
+// Append the packed values to output
+void pack_integers(std::span<const u32> values,
+                   std::string& output,
+                   bit_packing::mode mode = bit_packing::mode::plain);
+
+// Unpack input into values, replacing its content. False if input is not a
+// complete stream. Uses AVX2 when the CPU has it.
+bool unpack_integers(std::string_view input, beard::array<u32>& values);
+}  // namespace beard::io
@@ -11,10 +11,55 @@ i64 get_file_write_time(std::string_view filename);
 
 std::string read_whole_file(std::string_view filename);
 
+// Write (and truncate) the whole file at once. Returns false if the file could
+// not be opened or if less bytes than expected were written.
+bool write_whole_file(std::string_view filename, std::string_view content);
+
+// Replace the file with content, so that after a crash it holds either its
+// old content or the new one, never a mix. The content is written to a
+// temporary file next to it, synced to the disk, then renamed over it.
+bool write_whole_file_atomic(std::string_view filename,
+                             std::string_view content);
+
 beard::optional<std::string> read_while_file_if_newer(std::string_view filename,
                                                       i64 last_write,
                                                       i64* write_time);
 
-// std::u32string to_utf8(const std::string& str);
-// std::string from_utf8(const std::u32string& str);
+// Read only memory mapping of a whole file. The mapping lives as long as the
+// object, views obtained from it must not outlive it.
+class mapped_file {
+ public:
+  mapped_file() = default;
+  ~mapped_file();
+
+  NONCOPYABLE(mapped_file);
+  mapped_file(mapped_file&& other) noexcept;
+  mapped_file& operator=(mapped_file&& other) noexcept;
+
+  bool open(std::string_view filename);
+  void close();
+
+  bool is_open() const { return m_is_open; }
+
+  const char* data() const { return m_data; }
+  usize size() const { return m_size; }
+  std::string_view view() const { return {m_data, m_size}; }
+
+ private:
+  const char* m_data = nullptr;
+  usize m_size = 0;
+  bool m_is_open = false;
+
+#if BEARD_PLATFORM_WINDOWS
+  void* m_file = nullptr;
+  void* m_mapping = nullptr;
+#endif
+};
+
+// Decode UTF-8 text, empty if it is not valid UTF-8
+beard::optional<std::u32string> from_utf8(std::string_view text);
+
+// Encode text to UTF-8, empty if it holds surrogates or code points above
+// U+10FFFF
+beard::optional<std::string> to_utf8(std::u32string_view text);
 }  // namespace beard::io
\ No newline at end of file
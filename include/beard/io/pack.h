@@ -0,0 +1,144 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/containers/hash_map.h"
+#include "beard/core/macros.h"
+#include "beard/io/io.h"
+#include "beard/misc/optional.h"
+
+namespace beard::io {
+namespace pack_detail {
+// "BRDPACK1", little endian
+constexpr u64 MAGIC = 0x314b434150445242ull;
+constexpr u32 VERSION = 1;
+constexpr u64 SECTION_ALIGNMENT = 64;
+constexpr u64 BLOB_ALIGNMENT = 64;
+
+// The footer is the last thing in the file, so that the builder can stream
+// the blobs without knowing their sizes first. Every position in the file is
+// an offset from its start.
+struct footer {
+  u64 magic;
+  u32 version;
+  u32 slot_size;
+  u64 entry_count;
+  u64 slot_count;
+  u64 slots_offset;
+  u64 strings_offset;
+  u64 strings_size;
+  u64 total_size;
+};
+static_assert(sizeof(footer) == SECTION_ALIGNMENT);
+
+struct slot {
+  u64 hash;  // 0 means empty
+  u64 path_offset;
+  u32 path_length;
+  u32 crc;
+  u64 data_offset;
+  u64 data_size;
+};
+}  // namespace pack_detail
+
+// Collects files and writes them as a single pack. Each file is aligned on
+// BLOB_ALIGNMENT bytes, followed by a hash table of the paths, as in
+// frozen_hash_map, and the CRC32 of each file.
+class pack_builder {
+ public:
+  pack_builder() = default;
+  ~pack_builder() = default;
+
+  NONCOPYABLE(pack_builder);
+  DEFAULT_MOVEABLE(pack_builder);
+
+  // Add content under path, replacing any previous file with the same path
+  void add(std::string_view path, std::string_view content);
+
+  // Add the file at filename under path, it is only read by write
+  void add_file(std::string_view path, std::string_view filename);
+
+  i32 entry_count() const { return m_entries.element_count(); }
+
+  // False if a file could not be read or the pack could not be written
+  bool write(std::string_view filename) const;
+
+ private:
+  struct entry {
+    std::string path = {};
+    std::string content = {};
+    std::string filename = {};
+    bool is_file = false;
+  };
+
+  entry& entry_for(std::string_view path);
+
+  beard::array<entry> m_entries;
+  string_hash_map<i32> m_indices;
+};
+
+// Read only view of a pack, mapped in memory. Looking a file up is a hash
+// probe in the mapping, and its content is a view of the mapping: there is
+// no syscall nor copy after open. Views must not outlive the pack_file.
+//
+// open only checks the structure of the file, the content of the files is
+// checked against their CRC32 by verify.
+class pack_file {
+ public:
+  pack_file() = default;
+  ~pack_file() = default;
+
+  NONCOPYABLE(pack_file);
+  pack_file(pack_file&& other) noexcept;
+  pack_file& operator=(pack_file&& other) noexcept;
+
+  bool open(std::string_view filename);
+  void close();
+
+  bool is_open() const { return m_file.is_open(); }
+
+  i32 entry_count() const { return static_cast<i32>(m_entry_count); }
+
+  // Content of the file stored under path, empty if there is none
+  beard::optional<std::string_view> find(std::string_view path) const;
+
+  bool contains(std::string_view path) const {
+    return find_index(path) != m_slot_count;
+  }
+
+  // Check every file against its CRC32
+  bool verify() const;
+
+  // Call fn(path, content) for every file, in no particular order
+  template <typename Fn>
+  void for_each(Fn&& fn) const;
+
+ private:
+  u64 find_index(std::string_view path) const;
+  bool attach();
+
+  std::string_view path_of(const pack_detail::slot& slot) const {
+    return {m_strings + slot.path_offset, slot.path_length};
+  }
+  std::string_view content_of(const pack_detail::slot& slot) const {
+    return {m_file.data() + slot.data_offset, slot.data_size};
+  }
+
+  mapped_file m_file;
+  const pack_detail::slot* m_slots = nullptr;
+  const char* m_strings = nullptr;
+  u64 m_slot_count = 0;
+  u64 m_entry_count = 0;
+};
+
+template <typename Fn>
+void pack_file::for_each(Fn&& fn) const {
+  for (u64 i = 0; i < m_slot_count; ++i) {
+    if (m_slots[i].hash != 0) {
+      fn(path_of(m_slots[i]), content_of(m_slots[i]));
+    }
+  }
+}
+}  // namespace beard::io
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "beard/containers/array.h"
+#include "beard/containers/hash_map.h"
+#include "beard/containers/hash_set.h"
+#include "beard/core/macros.h"
+#include "beard/io/buffered_file_writer.h"
+#include "beard/misc/optional.h"
+
+namespace beard::io {
+class binary_writer;
+class binary_reader;
+
+// How a type is written and read back. Trivially copyable types are copied
+// as is, and arrays of them in a single copy. Other types specialize it:
+//
+//   template <>
+//   struct serial_traits<vertex> {
+//     static bool write(binary_writer& writer, const vertex& v) {
+//       return writer.write(v.position) && writer.write(v.name);
+//     }
+//     static bool read(binary_reader& reader, vertex& v) {
+//       return reader.read(v.position) && reader.read(v.name);
+//     }
+//   };
+template <typename T>
+struct serial_traits {
+  static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>,
+                "Specialize serial_traits to serialize this type");
+
+  // Only the types using this template are copied in bulk
+  static constexpr bool IS_RAW = true;
+
+  static bool write(binary_writer& writer, const T& value);
+  static bool read(binary_reader& reader, T& value);
+};
+
+// Streams start with a header holding the version of the data, so that
+// readers can still load what older versions wrote. Everything is little
+// endian: numbers, and arrays of them, are swapped on big endian machines.
+// Other trivially copyable types keep the layout of the machine that wrote
+// them.
+namespace serialization {
+// "BRDS"
+constexpr u32 MAGIC = 0x53445242;
+constexpr u32 FORMAT_VERSION = 1;
+
+struct header {
+  u32 magic;
+  u32 format_version;
+  u32 version;
+  u32 reserved;
+};
+
+template <typename T>
+constexpr bool is_raw = requires { serial_traits<T>::IS_RAW; };
+
+template <typename T>
+constexpr bool is_swapped = std::endian::native == std::endian::big &&
+                            (std::is_arithmetic_v<T> || std::is_enum_v<T>) &&
+                            sizeof(T) > 1;
+
+template <typename T>
+T byteswap(T value) {
+  char bytes[sizeof(T)];
+  memcpy(bytes, &value, sizeof(T));
+  std::reverse(bytes, bytes + sizeof(T));
+  memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+}  // namespace serialization
+
+// Writes to a string, or to a file through a buffered_file_writer. Large
+// writes go to the file directly, without being copied.
+class binary_writer {
+ public:
+  binary_writer() = default;
+  // Append to output, which must outlive the writer
+  explicit binary_writer(std::string& output) : m_output{&output} {}
+  ~binary_writer() { close(); }
+
+  NONCOPYABLE(binary_writer);
+  NONMOVEABLE(binary_writer);
+
+  bool open(std::string_view filename);
+
+  // Flush and close the file, false if any write failed
+  bool close();
+
+  bool write_header(u32 version);
+
+  bool write_bytes(const void* data, usize size) {
+    if (m_output != nullptr) {
+      m_output->append(static_cast<const char*>(data), size);
+      return true;
+    }
+    return m_file.write({static_cast<const char*>(data), size});
+  }
+
+  template <typename T>
+  bool write(const T& value) {
+    return serial_traits<T>::write(*this, value);
+  }
+
+  bool has_error() const { return m_output == nullptr && m_file.has_error(); }
+
+ private:
+  std::string* m_output = nullptr;
+  buffered_file_writer m_file;
+};
+
+// Reads from memory, or from a file with a small buffer. Large reads go from
+// the file to their destination directly, so that loading an array of
+// numbers is a single read whatever its size.
+//
+// Reads fail from the first error on: a truncated stream, or sizes that
+// could not fit in what is left of it.
+class binary_reader {
+ public:
+  static constexpr usize BUFFER_SIZE = KB(usize{64});
+
+  binary_reader() = default;
+  // Read bytes, which must outlive the reader
+  explicit binary_reader(std::string_view bytes)
+      : m_data{bytes.data()}, m_end{bytes.data() + bytes.size()} {}
+  ~binary_reader() { close(); }
+
+  NONCOPYABLE(binary_reader);
+  NONMOVEABLE(binary_reader);
+
+  bool open(std::string_view filename);
+  void close();
+
+  // The version given to write_header, empty if the stream does not start
+  // with a header this code can read
+  beard::optional<u32> read_header();
+
+  // Version from the header, for serial_traits to read older layouts
+  u32 version() const { return m_version; }
+
+  bool read_bytes(void* data, usize size) {
+    if (size <= static_cast<usize>(m_end - m_data)) {
+      // Empty reads can come with a null data
+      if (size > 0) {
+        memcpy(data, m_data, size);
+        m_data += size;
+      }
+      return true;
+    }
+    return read_slow(data, size);
+  }
+
+  template <typename T>
+  bool read(T& value) {
+    return serial_traits<T>::read(*this, value);
+  }
+
+  // Read a container size, failing if that many elements of element_size
+  // bytes cannot be left in the stream
+  bool read_count(usize& count, usize element_size);
+
+  // Bytes left in the stream
+  u64 remaining() const { return (m_end - m_data) + m_file_remaining; }
+
+  // Stop reading, for serial_traits that find invalid data
+  bool fail();
+
+  bool has_error() const { return m_has_error; }
+
+ private:
+  bool read_slow(void* data, usize size);
+
+  const char* m_data = nullptr;
+  const char* m_end = nullptr;
+  FILE* m_file = nullptr;
+  u64 m_file_remaining = 0;
+  std::unique_ptr<char[]> m_buffer;
+  u32 m_version = 0;
+  bool m_has_error = false;
+};
+
+template <typename T>
+bool serial_traits<T>::write(binary_writer& writer, const T& value) {
+  if constexpr (serialization::is_swapped<T>) {
+    T swapped = serialization::byteswap(value);
+    return writer.write_bytes(&swapped, sizeof(T));
+  } else {
+    return writer.write_bytes(&value, sizeof(T));
+  }
+}
+
+template <typename T>
+bool serial_traits<T>::read(binary_reader& reader, T& value) {
+  if (!reader.read_bytes(&value, sizeof(T))) {
+    return false;
+  }
+  if constexpr (serialization::is_swapped<T>) {
+    value = serialization::byteswap(value);
+  }
+  return true;
+}
+
+template <>
+struct serial_traits<std::string> {
+  static bool write(binary_writer& writer, const std::string& value) {
+    return writer.write(static_cast<u64>(value.size())) &&
+           writer.write_bytes(value.data(), value.size());
+  }
+
+  static bool read(binary_reader& reader, std::string& value) {
+    usize size = 0;
+    if (!reader.read_count(size, 1)) {
+      return false;
+    }
+    value.resize(size);
+    return reader.read_bytes(value.data(), size);
+  }
+};
+
+template <typename T>
+struct serial_traits<beard::optional<T>> {
+  static bool write(binary_writer& writer, const beard::optional<T>& value) {
+    if (!writer.write(static_cast<u8>(value.has_value()))) {
+      return false;
+    }
+    return !value.has_value() || writer.write(value.value());
+  }
+
+  static bool read(binary_reader& reader, beard::optional<T>& value) {
+    u8 has_value = 0;
+    if (!reader.read(has_value)) {
+      return false;
+    }
+    if (has_value > 1) {
+      return reader.fail();
+    }
+
+    value = beard::optional<T>{};
+    if (has_value == 1) {
+      T inner = {};
+      if (!reader.read(inner)) {
+        return false;
+      }
+      value = std::move(inner);
+    }
+    return true;
+  }
+};
+
+template <typename T>
+struct serial_traits<beard::array<T>> {
+  static bool write(binary_writer& writer, const beard::array<T>& values) {
+    if (!writer.write(static_cast<u64>(values.element_count()))) {
+      return false;
+    }
+    if constexpr (serialization::is_raw<T> &&
+                  !serialization::is_swapped<T>) {
+      return writer.write_bytes(values.data(), values.data_size());
+    } else {
+      for (const T& value : values) {
+        if (!writer.write(value)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  static bool read(binary_reader& reader, beard::array<T>& values) {
+    constexpr usize ELEMENT_SIZE = serialization::is_raw<T> ? sizeof(T) : 1;
+    usize count = 0;
+    if (!reader.read_count(count, ELEMENT_SIZE)) {
+      return false;
+    }
+    if (count > static_cast<usize>(std::numeric_limits<i32>::max())) {
+      return reader.fail();
+    }
+
+    values.resize(static_cast<i32>(count));
+    if constexpr (serialization::is_raw<T>) {
+      if (!reader.read_bytes(values.data(), values.data_size())) {
+        return false;
+      }
+      if constexpr (serialization::is_swapped<T>) {
+        for (T& value : values) {
+          value = serialization::byteswap(value);
+        }
+      }
+      return true;
+    } else {
+      for (T& value : values) {
+        if (!reader.read(value)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+};
+
+template <typename Key, typename Value>
+struct serial_traits<hash_map<Key, Value>> {
+  static bool write(binary_writer& writer, const hash_map<Key, Value>& map) {
+    if (!writer.write(static_cast<u64>(map.element_count()))) {
+      return false;
+    }
+    for (const auto& [key, value] : map) {
+      if (!writer.write(key) || !writer.write(value)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool read(binary_reader& reader, hash_map<Key, Value>& map) {
+    usize count = 0;
+    if (!reader.read_count(count, 2)) {
+      return false;
+    }
+
+    map.clear();
+    for (usize i = 0; i < count; ++i) {
+      Key key = {};
+      Value value = {};
+      if (!reader.read(key) || !reader.read(value)) {
+        return false;
+      }
+      map.add(std::move(key), std::move(value));
+    }
+    return true;
+  }
+};
+
+template <typename Key>
+struct serial_traits<hash_set<Key>> {
+  static bool write(binary_writer& writer, const hash_set<Key>& set) {
+    if (!writer.write(static_cast<u64>(set.element_count()))) {
+      return false;
+    }
+    for (const Key& key : set) {
+      if (!writer.write(key)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool read(binary_reader& reader, hash_set<Key>& set) {
+    usize count = 0;
+    if (!reader.read_count(count, 1)) {
+      return false;
+    }
+
+    set.clear();
+    for (usize i = 0; i < count; ++i) {
+      Key key = {};
+      if (!reader.read(key)) {
+        return false;
+      }
+      set.add(std::move(key));
+    }
+    return true;
+  }
+};
+
+template <typename Value>
+struct serial_traits<string_hash_map<Value>>
+    : serial_traits<hash_map<std::string, Value>> {};
+
+template <>
+struct serial_traits<string_hash_set> : serial_traits<hash_set<std::string>> {
+};
+}  // namespace beard::io
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+
+namespace beard {
+// Bump allocator working on big chunks of memory. Everything allocated lives
+// until reset() or the destruction of the arena, and never moves.
+class arena {
+ public:
+  explicit arena(usize chunk_size = KB(64));
+  ~arena();
+
+  NONCOPYABLE(arena);
+  arena(arena&& other) noexcept;
+  arena& operator=(arena&& other) noexcept;
+
+  void* allocate(usize size, usize alignment = alignof(std::max_align_t));
+
+  template <typename T>
+  T* allocate_array(usize count) {
+    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+  }
+
+  // Copy a string in the arena, the result is NOT null terminated
+  std::string_view copy_string(std::string_view string);
+
+  // Free everything but the first chunk, which is kept for reuse
+  void reset();
+
+  usize allocated_size() const { return m_allocated_size; }
+
+ private:
+  struct chunk {
+    char* data;
+    usize size;
+  };
+
+  array<chunk> m_chunks;
+  usize m_chunk_size;
+  usize m_offset = 0;
+  usize m_allocated_size = 0;
+};
+}  // namespace beard
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstring>
 #include <string_view>
 
 #include "beard/core/macros.h"
 
+#if BEARD_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
 namespace beard::crc32 {
 static constexpr u32 CRC_TABLE[256] = {
     0x00000000L, 0x77073096L, 0xee0e612cL, 0x990951baL, 0x076dc419L,
@@ -67,3 +72,100 @@ inline constexpr u32 hash(std::string_view string) {
   return crc ^ 0xffffffff;
 }
 }  // namespace beard::crc32
+
+namespace beard::hash64 {
+namespace detail {
+static constexpr u64 SECRET[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                  0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+inline void multiply(u64* a, u64* b) {
+#if BEARD_COMPILER_MSVC
+  u64 hi;
+  u64 lo = _umul128(*a, *b, &hi);
+  *a = lo;
+  *b = hi;
+#else
+  __uint128_t r = static_cast<__uint128_t>(*a) * *b;
+  *a = static_cast<u64>(r);
+  *b = static_cast<u64>(r >> 64);
+#endif
+}
+
+inline u64 mix(u64 a, u64 b) {
+  multiply(&a, &b);
+  return a ^ b;
+}
+
+inline u64 read64(const u8* p) {
+  u64 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline u64 read32(const u8* p) {
+  u32 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+}  // namespace detail
+
+// 64 bits non cryptographic hash, based on wyhash. Much faster than crc32 on
+// anything longer than a few bytes, and good enough for hash tables and
+// probabilistic structures.
+inline u64 hash(const void* data, usize length, u64 seed = 0) {
+  using namespace detail;
+
+  auto p = static_cast<const u8*>(data);
+  seed ^= mix(seed ^ SECRET[0], SECRET[1]);
+
+  u64 a, b;
+  if (BEARD_LIKELY(length <= 16)) {
+    if (length >= 4) {
+      usize delta = (length >> 3) << 2;
+      a = (read32(p) << 32) | read32(p + delta);
+      b = (read32(p + length - 4) << 32) | read32(p + length - 4 - delta);
+    } else if (length > 0) {
+      a = (u64{p[0]} << 16) | (u64{p[length >> 1]} << 8) | p[length - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    usize i = length;
+    if (i > 48) {
+      u64 see1 = seed;
+      u64 see2 = seed;
+      do {
+        seed = mix(read64(p) ^ SECRET[1], read64(p + 8) ^ seed);
+        see1 = mix(read64(p + 16) ^ SECRET[2], read64(p + 24) ^ see1);
+        see2 = mix(read64(p + 32) ^ SECRET[3], read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = mix(read64(p) ^ SECRET[1], read64(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = read64(p + i - 16);
+    b = read64(p + i - 8);
+  }
+
+  a ^= SECRET[1];
+  b ^= seed;
+  multiply(&a, &b);
+  return mix(a ^ SECRET[0] ^ length, b ^ SECRET[1]);
+}
+
+inline u64 hash(std::string_view string, u64 seed = 0) {
+  return hash(string.data(), string.size(), seed);
+}
+
+// A single multiply is not enough to spread close integers over the high
+// bits, which probabilistic structures rely on: go through the whole hash.
+inline u64 hash(u64 value, u64 seed = 0) {
+  return hash(&value, sizeof(value), seed);
+}
+}  // namespace beard::hash64
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/hash.h"
+
+namespace beard {
+// Cardinality estimator: counts distinct keys with a fixed and small amount
+// of memory (2^precision bytes once dense, 16KB for the default precision),
+// with a standard error of about 1.04 / sqrt(2^precision).
+//
+// Like HyperLogLog++, small cardinalities are kept in a sparse list of
+// registers with a higher precision, which is both smaller and more precise,
+// and switches to dense registers when the list would get bigger than them.
+// Instead of the empirical bias correction tables of HLL++, the estimate uses
+// the improved estimator from Otmar Ertl ("New cardinality estimation
+// algorithms for HyperLogLog sketches", 2017), which is unbiased on the whole
+// range.
+//
+// Estimators are not thread safe, but are cheap to merge: give each thread its
+// own and merge them at the end.
+class hyperloglog {
+ public:
+  static constexpr u32 MIN_PRECISION = 4;
+  static constexpr u32 MAX_PRECISION = 18;
+  static constexpr u32 SPARSE_PRECISION = 25;
+
+  explicit hyperloglog(u32 precision = 14);
+  ~hyperloglog() = default;
+
+  DEFAULT_CTORS(hyperloglog);
+
+  void add(std::string_view key) { add_hash(hash64::hash(key)); }
+  void add_hash(u64 hash);
+
+  f64 estimate() const;
+
+  // Both estimators must have the same precision, returns false otherwise
+  bool merge(const hyperloglog& other);
+
+  void clear();
+
+  u32 precision() const { return m_precision; }
+  bool is_sparse() const { return m_registers.is_empty(); }
+  usize memory_size() const;
+
+ private:
+  void flush_sparse_buffer();
+  void convert_to_dense();
+  void add_sparse_entry_to_dense(u32 entry);
+  f64 estimate_dense() const;
+
+  u32 m_precision;
+  // Sparse entries are index << 6 | rank at SPARSE_PRECISION. New ones go
+  // to an unsorted buffer, periodically merged into the sorted list.
+  array<u32> m_sparse;
+  array<u32> m_sparse_buffer;
+  // Empty while sparse
+  array<u8> m_registers;
+};
+}  // namespace beard
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+#include "beard/misc/arena.h"
+#include "beard/misc/optional.h"
+
+namespace beard {
+// Ids are dense and start at 0, so they can also index arrays directly
+using string_id = u32;
+
+// Stores each unique string once and gives it a stable id. Interned strings
+// never move, views returned by get() live as long as the interner.
+//
+// intern() can be called from several threads at once. Looking up a string
+// that is already interned (find, get, or intern hitting an existing string)
+// never takes a lock, only adding a new string does.
+class string_interner {
+ public:
+  string_interner();
+  ~string_interner();
+
+  NONCOPYABLE(string_interner);
+  NONMOVEABLE(string_interner);
+
+  string_id intern(std::string_view string);
+
+  beard::optional<string_id> find(std::string_view string) const;
+
+  std::string_view get(string_id id) const;
+
+  i32 element_count() const {
+    return static_cast<i32>(m_count.load(std::memory_order_acquire));
+  }
+
+ private:
+  struct entry {
+    const char* data;
+    u32 length;
+    u64 hash;
+  };
+
+  // Slots hold the high bits of the hash and id + 1, 0 being an empty slot
+  struct table {
+    u64 mask;
+    std::unique_ptr<std::atomic<u64>[]> slots;
+  };
+
+  // Entries are stored in segments of growing size so that growing never
+  // moves existing entries under the feet of readers
+  static constexpr u32 FIRST_SEGMENT_BITS = 10;
+  static constexpr u32 SEGMENT_COUNT = 32 - FIRST_SEGMENT_BITS;
+
+  const entry* find_entry(string_id id) const;
+  beard::optional<string_id> find(std::string_view string, u64 hash) const;
+  void insert_slot(table* t, u64 hash, string_id id);
+  void grow();
+
+  std::atomic<table*> m_table;
+  std::atomic<entry*> m_segments[SEGMENT_COUNT] = {};
+  std::atomic<u32> m_count = 0;
+
+  // Everything below is only touched while holding the lock
+  std::mutex m_mutex;
+  arena m_arena;
+  // Old tables can still be in use by readers, keep them until destruction
+  array<std::unique_ptr<table>> m_tables;
+};
+}  // namespace beard
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "beard/containers/array.h"
+#include "beard/core/macros.h"
+
+namespace beard {
+// Fixed set of worker threads running submitted tasks in order
+class thread_pool {
+ public:
+  // 0 uses one thread per hardware thread
+  explicit thread_pool(i32 thread_count = 0);
+  ~thread_pool();
+
+  NONCOPYABLE(thread_pool);
+  NONMOVEABLE(thread_pool);
+
+  void submit(std::function<void()> task);
+
+  // Call fn(i) for each i in [0, count) and wait for all of them. The
+  // calling thread takes part, so this also works from inside a task, or
+  // when the workers are busy.
+  template <typename Fn>
+  void parallel_for(i32 count, Fn&& fn);
+
+  i32 thread_count() const { return m_threads.element_count(); }
+
+  // Pool shared by the library functions that do not take one, created on
+  // first use
+  static thread_pool& shared();
+
+ private:
+  void run_worker();
+
+  beard::array<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_has_tasks;
+  std::deque<std::function<void()>> m_tasks;
+  bool m_is_stopping = false;
+};
+
+template <typename Fn>
+void thread_pool::parallel_for(i32 count, Fn&& fn) {
+  if (count <= 0) {
+    return;
+  }
+
+  // Helpers can start after the loop is over, when their worker was busy,
+  // so they share the counters and only touch fn for an index they claimed
+  struct loop_state {
+    std::atomic<i32> next_index{0};
+    std::atomic<i32> done_count{0};
+  };
+  auto state = std::make_shared<loop_state>();
+  auto run = [count, &fn](loop_state& s) {
+    for (i32 i = s.next_index.fetch_add(1, std::memory_order_relaxed);
+         i < count; i = s.next_index.fetch_add(1, std::memory_order_relaxed)) {
+      fn(i);
+      if (s.done_count.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+        s.done_count.notify_all();
+      }
+    }
+  };
+
+  i32 helper_count = std::max(0, std::min(count - 1, thread_count()));
+  for (i32 i = 0; i < helper_count; ++i) {
+    submit([state, run] { run(*state); });
+  }
+
+  // Only the indices are waited on, never the helpers, so that a caller
+  // inside a task does not wait for tasks queued behind it
+  run(*state);
+  for (i32 done = state->done_count.load(std::memory_order_acquire);
+       done < count; done = state->done_count.load(std::memory_order_acquire)) {
+    state->done_count.wait(done, std::memory_order_acquire);
+  }
+}
+}  // namespace beard
@@ -0,0 +1,90 @@
+#include "beard/misc/arena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace beard {
+arena::arena(usize chunk_size) : m_chunk_size{chunk_size} {}
+
+arena::~arena() {
+  for (auto& c : m_chunks) {
+    free(c.data);
+  }
+}
+
+arena::arena(arena&& other) noexcept
+    : m_chunks{std::move(other.m_chunks)},
+      m_chunk_size{other.m_chunk_size},
+      m_offset{other.m_offset},
+      m_allocated_size{other.m_allocated_size} {
+  other.m_chunks.clear();
+  other.m_offset = 0;
+  other.m_allocated_size = 0;
+}
+
+arena& arena::operator=(arena&& other) noexcept {
+  if (this != &other) {
+    for (auto& c : m_chunks) {
+      free(c.data);
+    }
+    m_chunks = std::move(other.m_chunks);
+    m_chunk_size = other.m_chunk_size;
+    m_offset = other.m_offset;
+    m_allocated_size = other.m_allocated_size;
+    other.m_chunks.clear();
+    other.m_offset = 0;
+    other.m_allocated_size = 0;
+  }
+  return *this;
+}
+
+void* arena::allocate(usize size, usize alignment) {
+  if (!m_chunks.is_empty()) {
+    auto& current = m_chunks.last();
+    usize aligned = (m_offset + alignment - 1) & ~(alignment - 1);
+    if (aligned + size <= current.size) {
+      m_offset = aligned + size;
+      m_allocated_size += size;
+      return current.data + aligned;
+    }
+  }
+
+  // Oversized allocations get a chunk of their own. malloc gives memory
+  // aligned for any fundamental type, which is all we promise.
+  usize chunk_size = size + alignment > m_chunk_size ? size + alignment
+                                                     : m_chunk_size;
+  chunk c = {static_cast<char*>(malloc(chunk_size)), chunk_size};
+  if (c.data == nullptr) {
+    return nullptr;
+  }
+
+  usize base = reinterpret_cast<usize>(c.data);
+  usize aligned = ((base + alignment - 1) & ~(alignment - 1)) - base;
+  m_chunks.add(c);
+  m_offset = aligned + size;
+  m_allocated_size += size;
+  return c.data + aligned;
+}
+
+std::string_view arena::copy_string(std::string_view string) {
+  if (string.empty()) {
+    return {};
+  }
+
+  auto data = static_cast<char*>(allocate(string.size(), 1));
+  memcpy(data, string.data(), string.size());
+  return {data, string.size()};
+}
+
+void arena::reset() {
+  for (i32 i = 1; i < m_chunks.element_count(); ++i) {
+    free(m_chunks[i].data);
+  }
+  if (m_chunks.element_count() > 1) {
+    m_chunks.resize(1);
+  }
+  m_offset = 0;
+  m_allocated_size = 0;
+}
+}  // namespace beard
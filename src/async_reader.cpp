@@ -0,0 +1,602 @@
+#include "beard/io/async_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#if !BEARD_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if BEARD_PLATFORM_LINUX
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace beard::io {
+namespace detail {
+struct read_request {
+  std::string path;
+  std::span<char> buffer;
+  u64 offset;
+  read_callback callback;
+
+  // io_uring progress: the file is open once fd is set
+  i32 fd = -1;
+  usize size = 0;
+};
+
+#if BEARD_PLATFORM_LINUX
+// Minimal io_uring wrapper, without liburing: the submission and completion
+// rings are shared with the kernel through mmap
+struct io_ring {
+  i32 fd = -1;
+  u32 entries = 0;
+
+  void* sq_ring = nullptr;
+  usize sq_ring_size = 0;
+  void* cq_ring = nullptr;
+  usize cq_ring_size = 0;
+  io_uring_sqe* sqes = nullptr;
+  usize sqes_size = 0;
+
+  u32* sq_head = nullptr;
+  u32* sq_tail = nullptr;
+  u32 sq_mask = 0;
+  u32* sq_array = nullptr;
+  u32 sq_local_tail = 0;
+  u32 to_submit = 0;
+
+  u32* cq_head = nullptr;
+  u32* cq_tail = nullptr;
+  u32 cq_mask = 0;
+  io_uring_cqe* cqes = nullptr;
+
+  // Written to wake the completion thread up when requests are queued
+  i32 wake_fd = -1;
+  u64 wake_value = 0;
+
+  // Operations submitted and not completed yet, the wake up read included
+  u32 in_flight = 0;
+
+  ~io_ring() {
+    if (sqes != nullptr) {
+      munmap(sqes, sqes_size);
+    }
+    if (cq_ring != nullptr && cq_ring != sq_ring) {
+      munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != nullptr) {
+      munmap(sq_ring, sq_ring_size);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    if (wake_fd >= 0) {
+      ::close(wake_fd);
+    }
+  }
+
+  template <typename T>
+  static T* at(void* ring, u32 offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+  }
+
+  bool setup(u32 entry_count) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd = static_cast<i32>(syscall(__NR_io_uring_setup, entry_count, &params));
+    if (fd < 0) {
+      return false;
+    }
+    entries = params.sq_entries;
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+    cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+
+    sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+    if (sq_ring == nullptr) {
+      return false;
+    }
+    cq_ring = single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+    if (cq_ring == nullptr) {
+      return false;
+    }
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe*>(map(sqes_size, IORING_OFF_SQES));
+    if (sqes == nullptr) {
+      return false;
+    }
+
+    sq_head = at<u32>(sq_ring, params.sq_off.head);
+    sq_tail = at<u32>(sq_ring, params.sq_off.tail);
+    sq_mask = *at<u32>(sq_ring, params.sq_off.ring_mask);
+    sq_array = at<u32>(sq_ring, params.sq_off.array);
+    sq_local_tail = *sq_tail;
+
+    cq_head = at<u32>(cq_ring, params.cq_off.head);
+    cq_tail = at<u32>(cq_ring, params.cq_off.tail);
+    cq_mask = *at<u32>(cq_ring, params.cq_off.ring_mask);
+    cqes = at<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+    return wake_fd >= 0 && supports_operations();
+  }
+
+  void* map(usize size, u64 offset) {
+    void* result =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+             fd, static_cast<off_t>(offset));
+    return result == MAP_FAILED ? nullptr : result;
+  }
+
+  // Opening and closing files through io_uring needs Linux 5.6
+  bool supports_operations() {
+    constexpr u32 OPERATION_COUNT = 256;
+    usize size =
+        sizeof(io_uring_probe) + OPERATION_COUNT * sizeof(io_uring_probe_op);
+    auto probe = std::make_unique<char[]>(size);
+    memset(probe.get(), 0, size);
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE,
+                probe.get(), OPERATION_COUNT) < 0) {
+      return false;
+    }
+
+    auto* operations = reinterpret_cast<io_uring_probe*>(probe.get());
+    for (u8 operation : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE}) {
+      if (operation > operations->last_op ||
+          (operations->ops[operation].flags & IO_URING_OP_SUPPORTED) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Called from other threads to interrupt submit_and_wait
+  void wake_up() const {
+    u64 value = 1;
+    while (::write(wake_fd, &value, sizeof(value)) < 0 && errno == EINTR) {
+    }
+  }
+
+  // Callers make sure that no more than entries operations are in flight,
+  // so there is always room in the submission queue
+  io_uring_sqe* next_sqe(u8 opcode, u64 user_data) {
+    u32 index = sq_local_tail & sq_mask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->user_data = user_data;
+    sq_array[index] = index;
+    ++sq_local_tail;
+    ++to_submit;
+    ++in_flight;
+    return sqe;
+  }
+
+  // Submit the queued operations and wait for at least one completion,
+  // false if the ring cannot be entered anymore
+  bool submit_and_wait() {
+    std::atomic_ref<u32>{*sq_tail}.store(sq_local_tail,
+                                         std::memory_order_release);
+    while (true) {
+      i64 result = syscall(__NR_io_uring_enter, fd, to_submit, 1,
+                           IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (result >= 0) {
+        to_submit -= static_cast<u32>(result);
+        if (to_submit == 0) {
+          return true;
+        }
+      } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        return false;
+      }
+    }
+  }
+
+  // Take back the operations the kernel did not consume, calling fn on each
+  // of them
+  template <typename Fn>
+  void drop_unsubmitted(Fn&& fn) {
+    for (u32 tail = sq_local_tail - to_submit; tail != sq_local_tail; ++tail) {
+      fn(sqes[tail & sq_mask]);
+    }
+    sq_local_tail -= to_submit;
+    in_flight -= to_submit;
+    to_submit = 0;
+    std::atomic_ref<u32>{*sq_tail}.store(sq_local_tail,
+                                         std::memory_order_release);
+  }
+
+  template <typename Fn>
+  void for_each_completion(Fn&& fn) {
+    u32 head = *cq_head;
+    u32 tail = std::atomic_ref<u32>{*cq_tail}.load(std::memory_order_acquire);
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes[head & cq_mask];
+      --in_flight;
+      fn(cqe.user_data, cqe.res);
+    }
+    std::atomic_ref<u32>{*cq_head}.store(head, std::memory_order_release);
+  }
+};
+#else
+struct io_ring {};
+#endif
+}  // namespace detail
+
+namespace {
+using detail::read_request;
+
+#if BEARD_PLATFORM_LINUX
+// user_data of the operations that are not reads of a request
+constexpr u64 WAKE_UP = 0;
+constexpr u64 CLOSE = 1;
+
+// Linux reads at most 0x7ffff000 bytes at a time, so longer buffers are read
+// 1GB at a time
+constexpr usize MAX_READ_SIZE = GB(usize{1});
+#endif
+
+read_result read_blocking(const read_request& request) {
+  read_result result;
+#if BEARD_PLATFORM_WINDOWS
+  FILE* file = fopen(request.path.c_str(), "rb");
+  if (file == nullptr) {
+    result.error = errno;
+    return result;
+  }
+  defer(fclose(file));
+
+  if (_fseeki64(file, static_cast<i64>(request.offset), SEEK_SET) != 0) {
+    result.error = errno;
+    return result;
+  }
+  result.size = fread(request.buffer.data(), 1, request.buffer.size(), file);
+  if (ferror(file)) {
+    result.error = EIO;
+  }
+#else
+  i32 fd = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    result.error = errno;
+    return result;
+  }
+  defer(::close(fd));
+
+  while (result.size < request.buffer.size()) {
+    ssize_t read_size =
+        pread(fd, request.buffer.data() + result.size,
+              request.buffer.size() - result.size,
+              static_cast<off_t>(request.offset + result.size));
+    if (read_size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      result.error = errno;
+      break;
+    }
+    if (read_size == 0) {
+      break;
+    }
+    result.size += static_cast<usize>(read_size);
+  }
+#endif
+  return result;
+}
+}  // namespace
+
+async_reader::async_reader(u32 queue_depth, thread_pool& fallback_pool)
+    : m_fallback_pool{fallback_pool} {
+#if BEARD_PLATFORM_LINUX
+  auto ring = std::make_unique<detail::io_ring>();
+  // The wake up read takes one of the entries
+  if (ring->setup(std::max(queue_depth, 2u))) {
+    m_ring = std::move(ring);
+    m_ring_thread = std::thread{[this] { run_ring(); }};
+  }
+#else
+  UNUSED(queue_depth);
+#endif
+}
+
+async_reader::~async_reader() {
+  wait();
+  if (m_ring_thread.joinable()) {
+    {
+      std::lock_guard lock{m_mutex};
+      m_is_stopping = true;
+    }
+#if BEARD_PLATFORM_LINUX
+    m_ring->wake_up();
+#endif
+    m_ring_thread.join();
+  }
+}
+
+void async_reader::read(std::string_view filename,
+                        std::span<char> buffer,
+                        read_callback callback,
+                        u64 offset) {
+  auto* request = new read_request{std::string{filename}, buffer, offset,
+                                   std::move(callback)};
+
+  bool is_queued = false;
+  bool should_wake_up = false;
+  {
+    std::lock_guard lock{m_mutex};
+    ++m_active_count;
+    if (m_ring != nullptr && !m_has_ring_failed) {
+      // The completion thread takes the whole queue at once, it only needs
+      // waking up for the first request
+      should_wake_up = m_queued.empty();
+      m_queued.push_back(request);
+      is_queued = true;
+    }
+  }
+
+  if (!is_queued) {
+    read_blocking_in_pool(request);
+    return;
+  }
+
+#if BEARD_PLATFORM_LINUX
+  if (should_wake_up) {
+    m_ring->wake_up();
+  }
+#else
+  UNUSED(should_wake_up);
+#endif
+}
+
+std::future<read_result> async_reader::read(std::string_view filename,
+                                            std::span<char> buffer,
+                                            u64 offset) {
+  auto promise = std::make_shared<std::promise<read_result>>();
+  auto future = promise->get_future();
+  read(
+      filename, buffer,
+      [promise](const read_result& result) { promise->set_value(result); },
+      offset);
+  return future;
+}
+
+void async_reader::wait() {
+  std::unique_lock lock{m_mutex};
+  m_is_idle.wait(lock, [this] { return m_active_count == 0; });
+}
+
+void async_reader::read_blocking_in_pool(read_request* request) {
+  m_fallback_pool.submit(
+      [this, request] { complete(request, read_blocking(*request)); });
+}
+
+void async_reader::complete(read_request* request, const read_result& result) {
+  request->callback(result);
+  delete request;
+
+  std::lock_guard lock{m_mutex};
+  if (--m_active_count == 0) {
+    m_is_idle.notify_all();
+  }
+}
+
+void async_reader::run_ring() {
+#if BEARD_PLATFORM_LINUX
+  detail::io_ring& ring = *m_ring;
+
+  auto queue_wake_up = [&] {
+    io_uring_sqe* sqe = ring.next_sqe(IORING_OP_READ, WAKE_UP);
+    sqe->fd = ring.wake_fd;
+    sqe->addr = reinterpret_cast<u64>(&ring.wake_value);
+    sqe->len = sizeof(ring.wake_value);
+  };
+
+  auto queue_read = [&](read_request* request) {
+    io_uring_sqe* sqe =
+        ring.next_sqe(IORING_OP_READ, reinterpret_cast<u64>(request));
+    sqe->fd = request->fd;
+    sqe->addr = reinterpret_cast<u64>(request->buffer.data() + request->size);
+    sqe->len = static_cast<u32>(
+        std::min(request->buffer.size() - request->size, MAX_READ_SIZE));
+    sqe->off = request->offset + request->size;
+  };
+
+  auto finish = [&](read_request* request, i32 error) {
+    if (request->fd >= 0) {
+      ring.next_sqe(IORING_OP_CLOSE, CLOSE)->fd = request->fd;
+    }
+    complete(request, {request->size, error});
+  };
+
+  bool has_failed = false;
+  queue_wake_up();
+  while (true) {
+    {
+      std::lock_guard lock{m_mutex};
+      // Every request has at most one operation in flight, its close
+      // replacing its last read
+      while (!m_queued.empty() && ring.in_flight < ring.entries) {
+        read_request* request = m_queued.front();
+        m_queued.pop_front();
+
+        io_uring_sqe* sqe =
+            ring.next_sqe(IORING_OP_OPENAT, reinterpret_cast<u64>(request));
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<u64>(request->path.c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+      }
+
+      if (m_is_stopping && m_queued.empty() && ring.in_flight == 1) {
+        break;
+      }
+    }
+
+    if (!ring.submit_and_wait()) {
+      has_failed = true;
+      break;
+    }
+    ring.for_each_completion([&](u64 user_data, i32 result) {
+      if (user_data == WAKE_UP) {
+        queue_wake_up();
+        return;
+      }
+      if (user_data == CLOSE) {
+        return;
+      }
+
+      auto* request = reinterpret_cast<read_request*>(user_data);
+      if (result < 0) {
+        finish(request, -result);
+      } else if (request->fd < 0) {
+        request->fd = result;
+        if (request->buffer.empty()) {
+          finish(request, 0);
+        } else {
+          queue_read(request);
+        }
+      } else {
+        request->size += static_cast<usize>(result);
+        if (result == 0 || request->size == request->buffer.size()) {
+          finish(request, 0);
+        } else {
+          queue_read(request);
+        }
+      }
+    });
+  }
+  if (!has_failed) {
+    return;
+  }
+
+  // io_uring_enter failed for good: the pool reads every request again from
+  // the start. Requests with operations in the kernel only move once these
+  // completed, so that nothing writes to their buffer afterwards.
+  auto fall_back = [&](read_request* request) {
+    if (request->fd >= 0) {
+      ::close(request->fd);
+      request->fd = -1;
+    }
+    request->size = 0;
+    read_blocking_in_pool(request);
+  };
+
+  ring.drop_unsubmitted([&](const io_uring_sqe& sqe) {
+    if (sqe.user_data == CLOSE) {
+      ::close(sqe.fd);
+    } else if (sqe.user_data != WAKE_UP) {
+      fall_back(reinterpret_cast<read_request*>(sqe.user_data));
+    }
+  });
+  std::deque<read_request*> queued;
+  {
+    std::lock_guard lock{m_mutex};
+    m_has_ring_failed = true;
+    queued.swap(m_queued);
+  }
+  for (read_request* request : queued) {
+    fall_back(request);
+  }
+
+  // Completes the wake up read if it was submitted
+  ring.wake_up();
+  while (ring.in_flight > 0) {
+    ring.for_each_completion([&](u64 user_data, i32 result) {
+      if (user_data == WAKE_UP || user_data == CLOSE) {
+        return;
+      }
+      auto* request = reinterpret_cast<read_request*>(user_data);
+      // A successful open, whose file has to be closed
+      if (request->fd < 0 && result >= 0) {
+        request->fd = result;
+      }
+      fall_back(request);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+#endif
+}
+
+bool file_batch::has_errors() const {
+  for (i32 error : m_errors) {
+    if (error != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+file_batch read_many_files(std::span<const std::string_view> paths,
+                           async_reader& reader) {
+  file_batch batch;
+  i32 file_count = static_cast<i32>(paths.size());
+  batch.m_contents.resize(file_count);
+  batch.m_errors.resize(file_count);
+
+  beard::array<usize> sizes;
+  sizes.resize(file_count);
+  thread_pool::shared().parallel_for(file_count, [&](i32 i) {
+#if BEARD_PLATFORM_WINDOWS
+    std::error_code error;
+    sizes[i] = std::filesystem::file_size(std::filesystem::path{paths[i]},
+                                          error);
+    if (error) {
+      sizes[i] = 0;
+      batch.m_errors[i] = error.value();
+    }
+#else
+    std::string path{paths[i]};
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+      batch.m_errors[i] = errno;
+    } else if (S_ISDIR(status.st_mode)) {
+      batch.m_errors[i] = EISDIR;
+    } else {
+      sizes[i] = static_cast<usize>(status.st_size);
+    }
+#endif
+  });
+
+  usize total_size = 0;
+  for (usize size : sizes) {
+    total_size += size;
+  }
+  batch.m_buffer = std::make_unique_for_overwrite<char[]>(total_size);
+
+  usize offset = 0;
+  for (i32 i = 0; i < file_count; ++i) {
+    if (batch.m_errors[i] != 0 || sizes[i] == 0) {
+      continue;
+    }
+
+    char* data = batch.m_buffer.get() + offset;
+    offset += sizes[i];
+    reader.read(paths[i], {data, sizes[i]},
+                [&batch, data, i](const read_result& result) {
+                  batch.m_contents[i] = {data, result.size};
+                  batch.m_errors[i] = result.error;
+                });
+  }
+  reader.wait();
+
+  return batch;
+}
+
+file_batch read_many_files(std::span<const std::string_view> paths) {
+  async_reader reader;
+  return read_many_files(paths, reader);
+}
+}  // namespace beard::io
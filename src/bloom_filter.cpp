@@ -0,0 +1,261 @@
+#include "beard/containers/bloom_filter.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "beard/core/cpu.h"
+
+#if BEARD_HAS_SSE2
+#include <immintrin.h>
+#endif
+
+namespace beard {
+namespace {
+using block = bloom_filter::block;
+
+// "BRBF"
+constexpr u32 MAGIC = 0x46425242;
+constexpr u32 VERSION = 1;
+constexpr i32 BATCH_SIZE = 16;
+
+struct header {
+  u32 magic;
+  u32 version;
+  u64 block_count;
+};
+
+// Kernels applying a batch of hashes, whose blocks are already prefetched
+void add_batch_scalar(block* blocks, u64 block_count, const u64* hashes,
+                      usize count) {
+  for (usize i = 0; i < count; ++i) {
+    u64 index = bloom_detail::block_index(hashes[i], block_count);
+    bloom_detail::set_bits(blocks[index], static_cast<u32>(hashes[i]));
+  }
+}
+
+void contains_batch_scalar(const block* blocks, u64 block_count,
+                           const u64* hashes, usize count, u8* results) {
+  for (usize i = 0; i < count; ++i) {
+    u64 index = bloom_detail::block_index(hashes[i], block_count);
+    results[i] =
+        bloom_detail::has_bits(blocks[index], static_cast<u32>(hashes[i]));
+  }
+}
+
+#if BEARD_HAS_SSE2
+// The 8 bits of a key, one in each word of the block
+BEARD_TARGET("avx2")
+__m256i make_mask(u32 key) {
+  const __m256i salt =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bloom_detail::SALT));
+  __m256i bits = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<i32>(key)), salt), 27);
+  return _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+}
+
+BEARD_TARGET("avx2")
+void add_batch_avx2(block* blocks, u64 block_count, const u64* hashes,
+                    usize count) {
+  for (usize i = 0; i < count; ++i) {
+    u64 index = bloom_detail::block_index(hashes[i], block_count);
+    auto words = reinterpret_cast<__m256i*>(blocks[index].words);
+    __m256i mask = make_mask(static_cast<u32>(hashes[i]));
+    _mm256_store_si256(words, _mm256_or_si256(_mm256_load_si256(words), mask));
+  }
+}
+
+BEARD_TARGET("avx2")
+void contains_batch_avx2(const block* blocks, u64 block_count,
+                         const u64* hashes, usize count, u8* results) {
+  for (usize i = 0; i < count; ++i) {
+    u64 index = bloom_detail::block_index(hashes[i], block_count);
+    auto words = _mm256_load_si256(
+        reinterpret_cast<const __m256i*>(blocks[index].words));
+    __m256i mask = make_mask(static_cast<u32>(hashes[i]));
+    results[i] = static_cast<u8>(_mm256_testc_si256(words, mask));
+  }
+}
+#endif
+
+struct bloom_kernels {
+  void (*add)(block*, u64, const u64*, usize) = add_batch_scalar;
+  void (*contains)(const block*, u64, const u64*, usize,
+                   u8*) = contains_batch_scalar;
+};
+
+bloom_kernels select_kernels() {
+  bloom_kernels kernels;
+#if BEARD_HAS_SSE2
+  if (get_cpu_features().avx2) {
+    kernels.add = add_batch_avx2;
+    kernels.contains = contains_batch_avx2;
+  }
+#endif
+  return kernels;
+}
+
+const bloom_kernels& get_kernels() {
+  static const bloom_kernels kernels = select_kernels();
+  return kernels;
+}
+}  // namespace
+
+bloom_filter::bloom_filter(u64 expected_element_count, f64 target_rate) {
+  f64 bits_per_key = 1.0;
+  while (bits_per_key < 64.0 &&
+         false_positive_rate(bits_per_key) > target_rate) {
+    bits_per_key += 0.25;
+  }
+
+  f64 bits = static_cast<f64>(expected_element_count) * bits_per_key;
+  auto count = static_cast<i32>(std::ceil(bits / (sizeof(block) * 8)));
+  m_blocks.resize(count > 0 ? count : 1);
+  clear();
+}
+
+f64 bloom_filter::false_positive_rate(f64 bits_per_key) {
+  // Keys per block follow a Poisson distribution, and a key with i other
+  // keys in its block is a false positive if all its 8 bits are set, each
+  // word holding i random bits out of 32.
+  f64 lambda = sizeof(block) * 8 / bits_per_key;
+  f64 probability = std::exp(-lambda);
+  f64 result = 0.0;
+  i32 last = static_cast<i32>(lambda + 20.0 * std::sqrt(lambda)) + 20;
+  for (i32 i = 0; i < last; ++i) {
+    result += probability * std::pow(1.0 - std::pow(31.0 / 32.0, i), 8);
+    probability *= lambda / (i + 1);
+  }
+  return result;
+}
+
+void bloom_filter::add_all(std::span<const std::string_view> keys) {
+  ASSERT(!m_blocks.is_empty(), "Adding to a filter that has not been sized");
+  const auto& kernels = get_kernels();
+  u64 block_count = static_cast<u64>(m_blocks.element_count());
+
+  u64 hashes[BATCH_SIZE];
+  for (usize start = 0; start < keys.size(); start += BATCH_SIZE) {
+    usize count = keys.size() - start < BATCH_SIZE ? keys.size() - start
+                                                   : BATCH_SIZE;
+    for (usize i = 0; i < count; ++i) {
+      hashes[i] = hash64::hash(keys[start + i]);
+      BEARD_PREFETCH(&block_for(hashes[i]));
+    }
+    kernels.add(m_blocks.data(), block_count, hashes, count);
+  }
+}
+
+void bloom_filter::add_all_hashes(std::span<const u64> hashes) {
+  ASSERT(!m_blocks.is_empty(), "Adding to a filter that has not been sized");
+  const auto& kernels = get_kernels();
+  u64 block_count = static_cast<u64>(m_blocks.element_count());
+
+  for (usize start = 0; start < hashes.size(); start += BATCH_SIZE) {
+    usize end = start + BATCH_SIZE < hashes.size() ? start + BATCH_SIZE
+                                                   : hashes.size();
+    for (usize i = start; i < end; ++i) {
+      BEARD_PREFETCH(&block_for(hashes[i]));
+    }
+    kernels.add(m_blocks.data(), block_count, hashes.data() + start,
+                end - start);
+  }
+}
+
+void bloom_filter::contains_all(std::span<const std::string_view> keys,
+                                array<u8>& results) const {
+  results.resize(static_cast<i32>(keys.size()));
+  if (m_blocks.is_empty()) {
+    memset(results.data(), 0, keys.size());
+    return;
+  }
+
+  const auto& kernels = get_kernels();
+  u64 block_count = static_cast<u64>(m_blocks.element_count());
+
+  u64 hashes[BATCH_SIZE];
+  for (usize start = 0; start < keys.size(); start += BATCH_SIZE) {
+    usize count = keys.size() - start < BATCH_SIZE ? keys.size() - start
+                                                   : BATCH_SIZE;
+    for (usize i = 0; i < count; ++i) {
+      hashes[i] = hash64::hash(keys[start + i]);
+      BEARD_PREFETCH(&block_for(hashes[i]));
+    }
+    kernels.contains(m_blocks.data(), block_count, hashes, count,
+                     results.data() + start);
+  }
+}
+
+void bloom_filter::contains_all_hashes(std::span<const u64> hashes,
+                                       array<u8>& results) const {
+  results.resize(static_cast<i32>(hashes.size()));
+  if (m_blocks.is_empty()) {
+    memset(results.data(), 0, hashes.size());
+    return;
+  }
+
+  const auto& kernels = get_kernels();
+  u64 block_count = static_cast<u64>(m_blocks.element_count());
+
+  for (usize start = 0; start < hashes.size(); start += BATCH_SIZE) {
+    usize end = start + BATCH_SIZE < hashes.size() ? start + BATCH_SIZE
+                                                   : hashes.size();
+    for (usize i = start; i < end; ++i) {
+      BEARD_PREFETCH(&block_for(hashes[i]));
+    }
+    kernels.contains(m_blocks.data(), block_count, hashes.data() + start,
+                     end - start, results.data() + start);
+  }
+}
+
+bool bloom_filter::merge(const bloom_filter& other) {
+  if (other.block_count() != block_count()) {
+    return false;
+  }
+
+  // Plain loop on contiguous words, the compiler vectorizes it just fine
+  auto dst = reinterpret_cast<u32*>(m_blocks.data());
+  auto src = reinterpret_cast<const u32*>(other.m_blocks.data());
+  usize word_count = m_blocks.data_size() / sizeof(u32);
+  for (usize i = 0; i < word_count; ++i) {
+    dst[i] |= src[i];
+  }
+
+  return true;
+}
+
+void bloom_filter::clear() {
+  if (!m_blocks.is_empty()) {
+    memset(m_blocks.data(), 0, m_blocks.data_size());
+  }
+}
+
+std::string bloom_filter::serialize() const {
+  header h = {MAGIC, VERSION, static_cast<u64>(m_blocks.element_count())};
+
+  std::string result(sizeof(header) + m_blocks.data_size(), '\0');
+  memcpy(result.data(), &h, sizeof(h));
+  if (!m_blocks.is_empty()) {
+    memcpy(result.data() + sizeof(h), m_blocks.data(), m_blocks.data_size());
+  }
+  return result;
+}
+
+bool bloom_filter::deserialize(std::string_view bytes) {
+  if (bytes.size() < sizeof(header)) {
+    return false;
+  }
+
+  header h;
+  memcpy(&h, bytes.data(), sizeof(h));
+  if (h.magic != MAGIC || h.version != VERSION ||
+      bytes.size() != sizeof(header) + h.block_count * sizeof(block)) {
+    return false;
+  }
+
+  m_blocks.resize(static_cast<i32>(h.block_count));
+  if (h.block_count != 0) {
+    memcpy(m_blocks.data(), bytes.data() + sizeof(h), m_blocks.data_size());
+  }
+  return true;
+}
+}  // namespace beard
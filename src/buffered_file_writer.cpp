@@ -0,0 +1,273 @@
+#include "beard/io/buffered_file_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include "beard/containers/array.h"
+
+#if BEARD_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace beard::io {
+namespace {
+#if !BEARD_PLATFORM_WINDOWS
+constexpr usize MAX_IOVEC_COUNT = 1024;
+#endif
+
+// Write every piece, the views are consumed as they are written
+bool write_all(i32 fd, std::span<std::string_view> pieces) {
+#if BEARD_PLATFORM_WINDOWS
+  for (std::string_view& piece : pieces) {
+    while (!piece.empty()) {
+      u32 size = static_cast<u32>(std::min<usize>(piece.size(), GB(1u)));
+      int written = _write(fd, piece.data(), size);
+      if (written < 0) {
+        return false;
+      }
+      piece.remove_prefix(static_cast<usize>(written));
+    }
+  }
+#else
+  usize first = 0;
+  while (first < pieces.size()) {
+    iovec vectors[MAX_IOVEC_COUNT];
+    usize count = std::min(pieces.size() - first, MAX_IOVEC_COUNT);
+    for (usize i = 0; i < count; ++i) {
+      vectors[i].iov_base = const_cast<char*>(pieces[first + i].data());
+      vectors[i].iov_len = pieces[first + i].size();
+    }
+
+    ssize_t written = writev(fd, vectors, static_cast<int>(count));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+
+    // Skip what was written, partial writes resume in the middle of a piece
+    usize remaining = static_cast<usize>(written);
+    while (first < pieces.size() && remaining >= pieces[first].size()) {
+      remaining -= pieces[first].size();
+      ++first;
+    }
+    if (first < pieces.size()) {
+      pieces[first].remove_prefix(remaining);
+    }
+  }
+#endif
+  return true;
+}
+
+usize round_up(usize size, usize alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+buffered_file_writer::buffered_file_writer(usize buffer_size)
+    : m_buffer_capacity{round_up(std::max<usize>(buffer_size, 1),
+                                 DIRECT_IO_ALIGNMENT)} {
+  m_buffer.reset(static_cast<char*>(::operator new[](
+      m_buffer_capacity, std::align_val_t{DIRECT_IO_ALIGNMENT})));
+}
+
+buffered_file_writer::~buffered_file_writer() { close(); }
+
+bool buffered_file_writer::open(std::string_view filename,
+                                write_mode mode,
+                                bool use_direct_io) {
+  close();
+
+  std::string path{filename};
+  i32 flags = mode == write_mode::append ? O_APPEND : O_TRUNC;
+#if BEARD_PLATFORM_WINDOWS
+  UNUSED(use_direct_io);
+  m_fd = _open(path.c_str(), flags | _O_WRONLY | _O_CREAT | _O_BINARY,
+               _S_IREAD | _S_IWRITE);
+#else
+  flags |= O_WRONLY | O_CREAT | O_CLOEXEC;
+#ifdef O_DIRECT
+  if (use_direct_io) {
+    m_fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+    m_is_direct = m_fd >= 0;
+
+    // Appending from an unaligned size is not possible with O_DIRECT
+    struct stat status;
+    if (m_is_direct && mode == write_mode::append &&
+        (fstat(m_fd, &status) != 0 ||
+         status.st_size % DIRECT_IO_ALIGNMENT != 0)) {
+      fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+      m_is_direct = false;
+    }
+  }
+#else
+  UNUSED(use_direct_io);
+#endif
+  // Not supported by the file system (tmpfs, ...), write through the cache
+  if (m_fd < 0) {
+    m_fd = ::open(path.c_str(), flags, 0644);
+  }
+#endif
+
+  m_buffer_size = 0;
+  m_written_size = 0;
+  m_has_error = m_fd < 0;
+  return m_fd >= 0;
+}
+
+bool buffered_file_writer::close() {
+  if (m_fd < 0) {
+    return !m_has_error;
+  }
+
+  if (m_is_direct) {
+    flush_direct(true);
+  } else {
+    flush();
+  }
+
+#if BEARD_PLATFORM_WINDOWS
+  m_has_error |= _close(m_fd) != 0;
+#else
+  m_has_error |= ::close(m_fd) != 0;
+#endif
+  m_fd = -1;
+  m_is_direct = false;
+  return !m_has_error;
+}
+
+bool buffered_file_writer::write(std::string_view data) {
+  if (m_fd < 0) {
+    return false;
+  }
+
+  if (data.empty()) {
+    return true;
+  }
+
+  if (data.size() <= m_buffer_capacity - m_buffer_size) {
+    memcpy(m_buffer.get() + m_buffer_size, data.data(), data.size());
+    m_buffer_size += data.size();
+    return true;
+  }
+
+  if (!m_is_direct) {
+    return write_pieces({&data, 1});
+  }
+
+  // Direct I/O only writes from the aligned buffer
+  while (!data.empty()) {
+    usize size = std::min(data.size(), m_buffer_capacity - m_buffer_size);
+    memcpy(m_buffer.get() + m_buffer_size, data.data(), size);
+    m_buffer_size += size;
+    data.remove_prefix(size);
+    if (m_buffer_size == m_buffer_capacity && !flush_direct(false)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool buffered_file_writer::write(std::span<const std::string_view> pieces) {
+  if (m_fd < 0) {
+    return false;
+  }
+
+  usize total_size = 0;
+  for (std::string_view piece : pieces) {
+    total_size += piece.size();
+  }
+
+  if (total_size > m_buffer_capacity - m_buffer_size && !m_is_direct) {
+    return write_pieces(pieces);
+  }
+
+  for (std::string_view piece : pieces) {
+    if (!write(piece)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool buffered_file_writer::write_pieces(
+    std::span<const std::string_view> pieces) {
+  beard::array<std::string_view> all_pieces;
+  all_pieces.reserve(static_cast<i32>(pieces.size()) + 1);
+  all_pieces.add({m_buffer.get(), m_buffer_size});
+  u64 total_size = m_buffer_size;
+  for (std::string_view piece : pieces) {
+    all_pieces.add(piece);
+    total_size += piece.size();
+  }
+
+  m_buffer_size = 0;
+  if (!write_all(m_fd, {all_pieces.data(),
+                        static_cast<usize>(all_pieces.element_count())})) {
+    m_has_error = true;
+    return false;
+  }
+  m_written_size += total_size;
+  return true;
+}
+
+bool buffered_file_writer::flush() {
+  if (m_fd < 0) {
+    return false;
+  }
+  if (m_is_direct) {
+    return flush_direct(false);
+  }
+  return m_buffer_size == 0 || write_pieces({});
+}
+
+bool buffered_file_writer::flush_direct(bool write_partial_block) {
+  // Only whole blocks go through O_DIRECT, the rest waits for more data, or
+  // for close or sync to write it without O_DIRECT
+  usize aligned_size =
+      m_buffer_size / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+  std::string_view pieces[] = {{m_buffer.get(), aligned_size}};
+  if (aligned_size > 0 && !write_all(m_fd, pieces)) {
+    m_has_error = true;
+    return false;
+  }
+
+  usize tail_size = m_buffer_size - aligned_size;
+  memmove(m_buffer.get(), m_buffer.get() + aligned_size, tail_size);
+  m_buffer_size = tail_size;
+  m_written_size += aligned_size;
+
+#if !BEARD_PLATFORM_WINDOWS && defined(O_DIRECT)
+  if (write_partial_block && tail_size > 0) {
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+    m_is_direct = false;
+    return flush();
+  }
+#else
+  UNUSED(write_partial_block);
+#endif
+  return true;
+}
+
+bool buffered_file_writer::sync() {
+  if (m_fd < 0 || !(m_is_direct ? flush_direct(true) : flush())) {
+    return false;
+  }
+#if BEARD_PLATFORM_WINDOWS
+  m_has_error |= _commit(m_fd) != 0;
+#else
+  m_has_error |= fsync(m_fd) != 0;
+#endif
+  return !m_has_error;
+}
+}  // namespace beard::io
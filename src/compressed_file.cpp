@@ -0,0 +1,194 @@
+#include "beard/io/compressed_file.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace beard::io {
+using namespace compression_frame;
+
+compressed_file_writer::compressed_file_writer(compression_level level,
+                                               usize block_size)
+    : m_level{level},
+      m_block_size{std::clamp<usize>(block_size, 1, MAX_BLOCK_SIZE)} {
+  m_block.reserve(m_block_size);
+  m_compressed.resize(sizeof(block_header) + compress_bound(m_block_size));
+}
+
+compressed_file_writer::~compressed_file_writer() { close(); }
+
+bool compressed_file_writer::open(std::string_view filename) {
+  close();
+  m_block.clear();
+  m_size = 0;
+  m_has_error = false;
+  if (!m_file.open(filename)) {
+    return false;
+  }
+
+  header h = {MAGIC, static_cast<u32>(m_block_size)};
+  return m_file.write({reinterpret_cast<const char*>(&h), sizeof(h)});
+}
+
+bool compressed_file_writer::close() {
+  if (!m_file.is_open()) {
+    return !m_has_error;
+  }
+
+  block_header end = {0, 0};
+  m_has_error |=
+      !write_block() ||
+      !m_file.write({reinterpret_cast<const char*>(&end), sizeof(end)});
+  m_has_error |= !m_file.close();
+  return !m_has_error;
+}
+
+bool compressed_file_writer::write(std::string_view data) {
+  if (!m_file.is_open()) {
+    return false;
+  }
+
+  m_size += data.size();
+  while (!data.empty()) {
+    usize size = std::min(data.size(), m_block_size - m_block.size());
+    m_block.append(data.data(), size);
+    data.remove_prefix(size);
+    if (m_block.size() == m_block_size && !write_block()) {
+      m_has_error = true;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool compressed_file_writer::write_block() {
+  if (m_block.empty()) {
+    return true;
+  }
+
+  char* stored = m_compressed.data() + sizeof(block_header);
+  usize stored_size = m_compressor.compress(
+      m_block, {stored, compress_bound(m_block.size())}, m_level);
+
+  block_header bh = {static_cast<u32>(stored_size),
+                     static_cast<u32>(m_block.size())};
+  std::string_view pieces[] = {{m_compressed.data(), sizeof(bh)},
+                               {stored, stored_size}};
+  if (stored_size >= m_block.size()) {
+    bh.stored_size = static_cast<u32>(m_block.size()) | STORED_FLAG;
+    pieces[1] = m_block;
+  }
+  memcpy(m_compressed.data(), &bh, sizeof(bh));
+
+  // pieces may point to m_block
+  bool is_written = m_file.write(pieces);
+  m_block.clear();
+  return is_written;
+}
+
+compressed_file_reader::compressed_file_reader(usize read_size)
+    : m_reader{read_size} {}
+
+bool compressed_file_reader::open(std::string_view filename) {
+  close();
+  if (!m_reader.open(filename)) {
+    return false;
+  }
+
+  m_is_at_end = false;
+  m_has_error = false;
+  header h;
+  if (!fill(sizeof(h))) {
+    close();
+    return false;
+  }
+  memcpy(&h, m_input.data(), sizeof(h));
+  m_input = m_input.subspan(sizeof(h));
+  if (h.magic != MAGIC || h.block_size == 0 || h.block_size > MAX_BLOCK_SIZE) {
+    close();
+    return false;
+  }
+  m_block_size = h.block_size;
+  return true;
+}
+
+void compressed_file_reader::close() {
+  m_reader.close();
+  m_input = {};
+  m_chunk = {};
+  m_is_at_end = true;
+}
+
+std::span<const char> compressed_file_reader::next_chunk(usize carry_over) {
+  if (m_is_at_end) {
+    return {};
+  }
+
+  ASSERT(carry_over <= m_chunk.size(), "Carrying over more than the chunk");
+  carry_over = std::min(carry_over, m_chunk.size());
+
+  block_header bh;
+  if (!fill(sizeof(bh))) {
+    return fail();
+  }
+  memcpy(&bh, m_input.data(), sizeof(bh));
+  m_input = m_input.subspan(sizeof(bh));
+
+  usize size = bh.size;
+  usize stored_size = bh.stored_size & ~STORED_FLAG;
+  bool is_stored = (bh.stored_size & STORED_FLAG) != 0;
+  if (bh.stored_size == 0 && size == 0) {
+    size = 0;
+    m_is_at_end = true;
+  } else if (size > m_block_size || (is_stored && stored_size != size) ||
+             !fill(stored_size)) {
+    return fail();
+  }
+
+  // The carried over tail is always in the output buffer
+  if (carry_over + size > m_output_capacity) {
+    m_output_capacity = std::max(carry_over + size, m_output_capacity * 2);
+    auto output = std::make_unique_for_overwrite<char[]>(m_output_capacity);
+    if (carry_over > 0) {
+      memcpy(output.get(), m_chunk.data() + m_chunk.size() - carry_over,
+             carry_over);
+    }
+    m_output = std::move(output);
+  } else if (carry_over > 0) {
+    memmove(m_output.get(), m_chunk.data() + m_chunk.size() - carry_over,
+            carry_over);
+  }
+
+  char* out = m_output.get() + carry_over;
+  if (is_stored) {
+    memcpy(out, m_input.data(), size);
+  } else if (size > 0) {
+    auto decompressed =
+        decompress_block(m_input.first(stored_size), {out, size});
+    if (!decompressed.has_value() || decompressed.value() != size) {
+      return fail();
+    }
+  }
+  m_input = m_input.subspan(stored_size);
+
+  m_chunk = {m_output.get(), carry_over + size};
+  return m_chunk.empty() ? std::span<const char>{} : m_chunk;
+}
+
+bool compressed_file_reader::fill(usize size) {
+  while (m_input.size() < size) {
+    auto chunk = m_reader.next_chunk(m_input.size());
+    if (chunk.size() <= m_input.size()) {
+      return false;
+    }
+    m_input = chunk;
+  }
+  return true;
+}
+
+std::span<const char> compressed_file_reader::fail() {
+  m_has_error = true;
+  m_is_at_end = true;
+  m_chunk = {};
+  return {};
+}
+}  // namespace beard::io
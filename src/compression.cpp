@@ -0,0 +1,465 @@
+#include "beard/io/compression.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace beard::io {
+namespace {
+constexpr i32 MIN_MATCH = 4;
+// The format ends blocks with literals, and no match starts in the last
+// MATCH_FIND_LIMIT bytes, which leaves the decoder room for wide copies
+constexpr i32 LAST_LITERALS = 5;
+constexpr i32 MATCH_FIND_LIMIT = 12;
+constexpr i32 MAX_OFFSET = 65535;
+constexpr i32 WINDOW_MASK = 0xffff;
+constexpr i32 HASH_LOG = 16;
+constexpr i32 RUN_MASK = 15;
+
+u32 read32(const u8* p) {
+  u32 value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+u64 read64(const u8* p) {
+  u64 value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+u32 hash_of(u32 value) { return (value * 2654435761u) >> (32 - HASH_LOG); }
+
+// Number of equal bytes at a and b, b stopping at b_end
+i32 common_length(const u8* a, const u8* b, const u8* b_end) {
+  const u8* start = b;
+  while (b + 8 <= b_end) {
+    u64 difference = read64(a) ^ read64(b);
+    if (difference != 0) {
+      return static_cast<i32>(b - start) + std::countr_zero(difference) / 8;
+    }
+    a += 8;
+    b += 8;
+  }
+  while (b < b_end && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return static_cast<i32>(b - start);
+}
+
+struct match {
+  i32 length = 0;
+  i32 offset = 0;
+};
+
+// Positions sharing a hash are chained, each one storing the distance to
+// the previous one, in a table indexed by position modulo the window
+class match_finder {
+ public:
+  match_finder(const u8* input,
+               i32 match_end,
+               i32 max_attempts,
+               i32* heads,
+               u16* chains)
+      : m_input{input},
+        m_match_end{match_end},
+        m_max_attempts{max_attempts},
+        m_heads{heads},
+        m_chains{chains} {
+    memset(m_heads, 0xff, sizeof(i32) << HASH_LOG);
+  }
+
+  // Positions before position are not worth inserting
+  void skip_to(i32 position) {
+    m_next_insert = std::max(m_next_insert, position);
+  }
+
+  // Longest match for position, which is inserted
+  match find(i32 position) {
+    insert_until(position);
+
+    match best;
+    u32 value = read32(m_input + position);
+    u32 hash = hash_of(value);
+    i32 candidate = m_heads[hash];
+    insert(position, hash);
+    m_next_insert = position + 1;
+    for (i32 attempts = m_max_attempts;
+         attempts > 0 && candidate >= 0 && position - candidate <= MAX_OFFSET;
+         --attempts) {
+      if (read32(m_input + candidate) == value) {
+        i32 length = MIN_MATCH + common_length(m_input + candidate + MIN_MATCH,
+                                               m_input + position + MIN_MATCH,
+                                               m_input + m_match_end);
+        if (length > best.length) {
+          best = {length, position - candidate};
+          if (position + length == m_match_end) {
+            break;
+          }
+        }
+      }
+
+      // The slot of candidate was not reused, position is less than a
+      // window ahead
+      u16 delta = m_chains[candidate & WINDOW_MASK];
+      if (delta == 0) {
+        break;
+      }
+      candidate -= delta;
+    }
+    return best;
+  }
+
+ private:
+  void insert(i32 position, u32 hash) {
+    i32 previous = m_heads[hash];
+    i32 delta = position - previous;
+    m_chains[position & WINDOW_MASK] =
+        previous >= 0 && delta <= MAX_OFFSET ? static_cast<u16>(delta) : 0;
+    m_heads[hash] = position;
+  }
+
+  void insert_until(i32 position) {
+    for (; m_next_insert < position; ++m_next_insert) {
+      insert(m_next_insert, hash_of(read32(m_input + m_next_insert)));
+    }
+  }
+
+  const u8* m_input;
+  i32 m_match_end;
+  i32 m_max_attempts;
+  i32* m_heads;
+  u16* m_chains;
+  i32 m_next_insert = 0;
+};
+
+// Writes the sequences of a block. Short literal runs are copied 16 bytes
+// at once when both buffers have room for it.
+class sequence_writer {
+ public:
+  sequence_writer(u8* out, const u8* out_end, const u8* in_end)
+      : m_out{out}, m_out_end{out_end}, m_in_end{in_end} {}
+
+  void write_literals(const u8* literals, usize count, u8 match_token = 0) {
+    u8 literal_token = static_cast<u8>(std::min<usize>(count, RUN_MASK));
+    *m_out++ = static_cast<u8>(literal_token << 4 | match_token);
+    if (count >= RUN_MASK) {
+      write_length(count - RUN_MASK);
+    }
+    if (count <= 16 && m_in_end - literals >= 16 && m_out_end - m_out >= 16) {
+      memcpy(m_out, literals, 16);
+    } else {
+      memcpy(m_out, literals, count);
+    }
+    m_out += count;
+  }
+
+  void write_sequence(const u8* literals, usize count, match m) {
+    usize match_length = static_cast<usize>(m.length - MIN_MATCH);
+    write_literals(literals, count,
+                   static_cast<u8>(std::min<usize>(match_length, RUN_MASK)));
+    *m_out++ = static_cast<u8>(m.offset);
+    *m_out++ = static_cast<u8>(m.offset >> 8);
+    if (match_length >= RUN_MASK) {
+      write_length(match_length - RUN_MASK);
+    }
+  }
+
+  u8* out() const { return m_out; }
+
+ private:
+  void write_length(usize length) {
+    while (length >= 255) {
+      *m_out++ = 255;
+      length -= 255;
+    }
+    *m_out++ = static_cast<u8>(length);
+  }
+
+  u8* m_out;
+  const u8* m_out_end;
+  const u8* m_in_end;
+};
+
+// Extension bytes of a length, false if the input ends first
+bool read_length(const u8*& in, const u8* in_end, usize& length) {
+  u8 byte;
+  do {
+    if (in == in_end) {
+      return false;
+    }
+    byte = *in++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+}  // namespace
+
+block_compressor::block_compressor()
+    : m_heads{std::make_unique_for_overwrite<i32[]>(usize{1} << HASH_LOG)},
+      m_chains{
+          std::make_unique_for_overwrite<u16[]>(usize{WINDOW_MASK} + 1)} {}
+
+block_compressor::~block_compressor() = default;
+
+usize block_compressor::compress(std::span<const char> input,
+                                 std::span<char> output,
+                                 compression_level level) {
+  ASSERT(output.size() >= compress_bound(input.size()),
+         "The output must hold compress_bound bytes");
+  ASSERT(input.size() < usize{1} << 31, "Blocks are limited to 2GB");
+
+  auto in = reinterpret_cast<const u8*>(input.data());
+  auto out = reinterpret_cast<u8*>(output.data());
+  i32 size = static_cast<i32>(input.size());
+  sequence_writer writer{out, out + output.size(), in + size};
+  i32 anchor = 0;
+
+  if (size > MATCH_FIND_LIMIT) {
+    bool is_lazy = level == compression_level::high;
+    match_finder finder{in, size - LAST_LITERALS, is_lazy ? 64 : 4,
+                        m_heads.get(), m_chains.get()};
+
+    // Fast compression only inserts the positions that are searched, plus
+    // the end of the matches, and searches less and less often in data that
+    // does not compress
+    i32 last_position = size - MATCH_FIND_LIMIT;
+    i32 position = 0;
+    i32 miss_count = 0;
+    while (position <= last_position) {
+      match m = finder.find(position);
+      if (m.length < MIN_MATCH) {
+        if (is_lazy) {
+          ++position;
+        } else {
+          position += 1 + (miss_count++ >> 6);
+          finder.skip_to(position);
+        }
+        continue;
+      }
+      miss_count = 0;
+
+      // Take the match at the next position instead when it is longer
+      while (is_lazy && position < last_position) {
+        match next = finder.find(position + 1);
+        if (next.length <= m.length) {
+          break;
+        }
+        m = next;
+        ++position;
+      }
+
+      while (position > anchor && position > m.offset &&
+             in[position - 1] == in[position - 1 - m.offset]) {
+        --position;
+        ++m.length;
+      }
+
+      writer.write_sequence(in + anchor, position - anchor, m);
+      position += m.length;
+      anchor = position;
+      if (!is_lazy) {
+        finder.skip_to(position - 2);
+      }
+    }
+  }
+
+  writer.write_literals(in + anchor, size - anchor);
+  return static_cast<usize>(writer.out() - out);
+}
+
+usize compress_block(std::span<const char> input,
+                     std::span<char> output,
+                     compression_level level) {
+  block_compressor compressor;
+  return compressor.compress(input, output, level);
+}
+
+beard::optional<usize> decompress_block(std::span<const char> input,
+                                        std::span<char> output) {
+  auto in = reinterpret_cast<const u8*>(input.data());
+  const u8* in_end = in + input.size();
+  auto out_start = reinterpret_cast<u8*>(output.data());
+  u8* out = out_start;
+  u8* out_end = out + output.size();
+
+  while (in < in_end) {
+    u8 token = *in++;
+
+    // Short literals are copied 16 bytes at once when there is room
+    usize literal_count = token >> 4;
+    if (literal_count != RUN_MASK && in_end - in >= 16 &&
+        out_end - out >= 16) {
+      memcpy(out, in, 16);
+    } else {
+      if (literal_count == RUN_MASK &&
+          !read_length(in, in_end, literal_count)) {
+        return {};
+      }
+      if (literal_count > static_cast<usize>(in_end - in) ||
+          literal_count > static_cast<usize>(out_end - out)) {
+        return {};
+      }
+      if (literal_count > 0) {
+        memcpy(out, in, literal_count);
+      }
+    }
+    in += literal_count;
+    out += literal_count;
+
+    // The last sequence has no match
+    if (in == in_end) {
+      break;
+    }
+
+    if (in_end - in < 2) {
+      return {};
+    }
+    usize offset = in[0] | usize{in[1]} << 8;
+    in += 2;
+    if (offset == 0 || offset > static_cast<usize>(out - out_start)) {
+      return {};
+    }
+
+    usize length = token & RUN_MASK;
+    if (length == RUN_MASK && !read_length(in, in_end, length)) {
+      return {};
+    }
+    length += MIN_MATCH;
+    if (length > static_cast<usize>(out_end - out)) {
+      return {};
+    }
+
+    // Copies may write up to 15 bytes past the match, which are overwritten
+    // by the next sequence
+    const u8* source = out - offset;
+    u8* match_end = out + length;
+    if (offset >= 16 && out_end - match_end >= 16) {
+      do {
+        memcpy(out, source, 16);
+        out += 16;
+        source += 16;
+      } while (out < match_end);
+    } else if (offset >= 8 && out_end - match_end >= 8) {
+      do {
+        memcpy(out, source, 8);
+        out += 8;
+        source += 8;
+      } while (out < match_end);
+    } else {
+      // Overlapping copy, repeating the last offset bytes
+      while (out < match_end) {
+        *out++ = *source++;
+      }
+    }
+    out = match_end;
+  }
+
+  return static_cast<usize>(out - out_start);
+}
+
+std::string compress(std::string_view data,
+                     compression_level level,
+                     usize block_size) {
+  using namespace compression_frame;
+  block_size = std::clamp<usize>(block_size, 1, MAX_BLOCK_SIZE);
+
+  std::string result;
+  header h = {MAGIC, static_cast<u32>(block_size)};
+  result.append(reinterpret_cast<const char*>(&h), sizeof(h));
+
+  block_compressor compressor;
+  while (!data.empty()) {
+    std::string_view block = data.substr(0, block_size);
+    data.remove_prefix(block.size());
+
+    usize block_start = result.size();
+    result.resize(block_start + sizeof(block_header) +
+                  compress_bound(block.size()));
+    char* stored = result.data() + block_start + sizeof(block_header);
+    usize stored_size = compressor.compress(
+        block, {stored, compress_bound(block.size())}, level);
+
+    block_header bh = {static_cast<u32>(stored_size),
+                       static_cast<u32>(block.size())};
+    if (stored_size >= block.size()) {
+      memcpy(stored, block.data(), block.size());
+      stored_size = block.size();
+      bh.stored_size = static_cast<u32>(stored_size) | STORED_FLAG;
+    }
+    memcpy(result.data() + block_start, &bh, sizeof(bh));
+    result.resize(block_start + sizeof(bh) + stored_size);
+  }
+
+  block_header end = {0, 0};
+  result.append(reinterpret_cast<const char*>(&end), sizeof(end));
+  return result;
+}
+
+beard::optional<std::string> decompress(std::string_view frame) {
+  using namespace compression_frame;
+
+  header h;
+  if (frame.size() < sizeof(h)) {
+    return {};
+  }
+  memcpy(&h, frame.data(), sizeof(h));
+  if (h.magic != MAGIC || h.block_size == 0 || h.block_size > MAX_BLOCK_SIZE) {
+    return {};
+  }
+
+  // Walk the blocks once to know the total size
+  usize total_size = 0;
+  usize position = sizeof(h);
+  while (true) {
+    block_header bh;
+    if (frame.size() - position < sizeof(bh)) {
+      return {};
+    }
+    memcpy(&bh, frame.data() + position, sizeof(bh));
+    position += sizeof(bh);
+    if (bh.stored_size == 0 && bh.size == 0) {
+      break;
+    }
+
+    usize stored_size = bh.stored_size & ~STORED_FLAG;
+    if (bh.size > h.block_size || frame.size() - position < stored_size ||
+        ((bh.stored_size & STORED_FLAG) != 0 && stored_size != bh.size)) {
+      return {};
+    }
+    position += stored_size;
+    total_size += bh.size;
+  }
+  if (position != frame.size()) {
+    return {};
+  }
+
+  std::string result;
+  result.resize(total_size);
+  char* out = result.data();
+  position = sizeof(h);
+  while (true) {
+    block_header bh;
+    memcpy(&bh, frame.data() + position, sizeof(bh));
+    position += sizeof(bh);
+    if (bh.stored_size == 0 && bh.size == 0) {
+      break;
+    }
+
+    usize stored_size = bh.stored_size & ~STORED_FLAG;
+    const char* stored = frame.data() + position;
+    if ((bh.stored_size & STORED_FLAG) != 0) {
+      memcpy(out, stored, stored_size);
+    } else {
+      auto size = decompress_block({stored, stored_size}, {out, bh.size});
+      if (!size.has_value() || size.value() != bh.size) {
+        return {};
+      }
+    }
+    position += stored_size;
+    out += bh.size;
+  }
+  return result;
+}
+}  // namespace beard::io
@@ -0,0 +1,68 @@
+#include "beard/core/cpu.h"
+
+#if BEARD_COMPILER_MSVC
+#include <intrin.h>
+#elif BEARD_HAS_SSE2
+#include <cpuid.h>
+#endif
+
+namespace beard {
+namespace {
+#if BEARD_HAS_SSE2
+void cpuid(u32 leaf, u32 subleaf, u32 registers[4]) {
+#if BEARD_COMPILER_MSVC
+  int r[4];
+  __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (i32 i = 0; i < 4; ++i) {
+    registers[i] = static_cast<u32>(r[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2],
+                registers[3]);
+#endif
+}
+
+u64 xgetbv() {
+#if BEARD_COMPILER_MSVC
+  return _xgetbv(0);
+#else
+  u32 eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (u64{edx} << 32) | eax;
+#endif
+}
+#endif
+
+cpu_features detect() {
+  cpu_features result;
+
+#if BEARD_HAS_SSE2
+  u32 r[4];
+  cpuid(0, 0, r);
+  u32 max_leaf = r[0];
+
+  cpuid(1, 0, r);
+  result.sse42 = (r[2] >> 20) & 1;
+  result.pclmul = (r[2] >> 1) & 1;
+
+  // AVX registers are only usable if the OS saves them on context switches
+  bool osxsave = (r[2] >> 27) & 1;
+  bool avx = (r[2] >> 28) & 1;
+  bool ymm_enabled = osxsave && (xgetbv() & 6) == 6;
+
+  if (max_leaf >= 7) {
+    cpuid(7, 0, r);
+    result.avx2 = avx && ymm_enabled && ((r[1] >> 5) & 1);
+    result.bmi2 = (r[1] >> 8) & 1;
+  }
+#endif
+
+  return result;
+}
+}  // namespace
+
+const cpu_features& get_cpu_features() {
+  local_variable const cpu_features features = detect();
+  return features;
+}
+}  // namespace beard
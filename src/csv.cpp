@@ -0,0 +1,275 @@
+#include "beard/fmt/csv.h"
+
+#include <cstring>
+#include <string>
+
+namespace beard::fmt {
+namespace {
+constexpr usize MINIMUM_CHUNK_SIZE = 64;
+
+std::string special_characters(char delimiter, char quote) {
+  return {delimiter, quote, '\n'};
+}
+}  // namespace
+
+csv_reader::csv_reader(char delimiter, char quote, usize chunk_size)
+    : m_special_characters{special_characters(delimiter, quote)},
+      m_quote{quote},
+      m_chunk_size{chunk_size < MINIMUM_CHUNK_SIZE ? MINIMUM_CHUNK_SIZE
+                                                   : chunk_size} {}
+
+csv_reader::~csv_reader() { close(); }
+
+bool csv_reader::open(std::string_view filename) {
+  close();
+
+  std::string path{filename};
+  m_file = fopen(path.c_str(), "rb");
+  if (m_file == nullptr) {
+    return false;
+  }
+
+  m_buffer.resize(m_chunk_size);
+  m_is_at_end = false;
+  return true;
+}
+
+void csv_reader::open_from_memory(std::string_view buffer) {
+  close();
+
+  m_data = buffer;
+  m_scanner = {m_data, &m_special_characters};
+}
+
+void csv_reader::close() {
+  if (m_file != nullptr) {
+    fclose(m_file);
+    m_file = nullptr;
+  }
+
+  m_is_at_end = true;
+  m_has_error = false;
+  m_data = {};
+  m_scanner = {};
+  m_position = 0;
+  m_line_number = 1;
+  m_header.clear();
+}
+
+bool csv_reader::next_row(csv_row& row) {
+  for (;;) {
+    switch (parse_row(row)) {
+      case parse_status::complete:
+        return true;
+      case parse_status::end:
+        return false;
+      case parse_status::error:
+        m_has_error = true;
+        return false;
+      case parse_status::incomplete:
+        if (!refill()) {
+          return false;
+        }
+        break;
+    }
+  }
+}
+
+bool csv_reader::read_header() {
+  csv_row row;
+  if (!next_row(row)) {
+    return false;
+  }
+
+  m_header.clear();
+  for (auto field : row.fields()) {
+    m_header.add(std::string{field});
+  }
+  return true;
+}
+
+i32 csv_reader::column_index(std::string_view name) const {
+  for (i32 i = 0; i < m_header.element_count(); ++i) {
+    if (m_header[i] == name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+csv_reader::parse_status csv_reader::parse_row(csv_row& row) {
+  row.m_fields.clear();
+  row.m_line_number = m_line_number;
+  m_unescaped.clear();
+  m_unescaped_fields.clear();
+
+  usize field_start = m_position;
+  usize quote_end = 0;
+  bool in_quotes = false;
+  bool quoted = false;
+  bool has_escaped_quotes = false;
+  i64 line_count = 0;
+
+  // Only the delimiters, quotes and new lines are looked at, the scanner
+  // finding them a whole block at a time
+  for (;;) {
+    usize position = m_scanner.next();
+
+    if (position == std::string_view::npos) {
+      if (!m_is_at_end) {
+        return parse_status::incomplete;
+      }
+      if (in_quotes) {
+        return parse_status::error;
+      }
+      if (field_start == m_data.size() && row.m_fields.is_empty()) {
+        m_position = field_start;
+        return parse_status::end;
+      }
+
+      // Last record, without a new line at the end of the input
+      usize field_end = m_data.size();
+      if (!quoted && field_end > field_start &&
+          m_data[field_end - 1] == '\r') {
+        --field_end;
+      }
+      add_field(row, field_start, quoted ? quote_end : field_end, quoted,
+                has_escaped_quotes);
+      m_position = m_data.size();
+      m_line_number += line_count;
+      return parse_status::complete;
+    }
+
+    char c = m_data[position];
+    line_count += c == '\n';
+
+    if (in_quotes) {
+      if (c != m_quote) {
+        continue;
+      }
+
+      // Whether this is an escaped quote depends on the next character
+      if (position + 1 == m_data.size() && !m_is_at_end) {
+        return parse_status::incomplete;
+      }
+      if (position + 1 < m_data.size() && m_data[position + 1] == m_quote) {
+        has_escaped_quotes = true;
+        m_scanner.next();
+        continue;
+      }
+
+      in_quotes = false;
+      quote_end = position;
+      continue;
+    }
+
+    if (c == m_quote) {
+      // Quotes in the middle of an unquoted field are kept as they are
+      if (position == field_start) {
+        in_quotes = true;
+        quoted = true;
+      }
+      continue;
+    }
+
+    usize field_end = position;
+    if (c == '\n' && !quoted && field_end > field_start &&
+        m_data[field_end - 1] == '\r') {
+      --field_end;
+    }
+
+    if (c == '\n' && row.m_fields.is_empty() && !quoted &&
+        field_end == field_start) {
+      // Empty line
+      field_start = position + 1;
+      m_position = field_start;
+      m_line_number += line_count;
+      line_count = 0;
+      row.m_line_number = m_line_number;
+      continue;
+    }
+
+    add_field(row, field_start, quoted ? quote_end : field_end, quoted,
+              has_escaped_quotes);
+
+    if (c == '\n') {
+      m_position = position + 1;
+      m_line_number += line_count;
+      return parse_status::complete;
+    }
+
+    field_start = position + 1;
+    quoted = false;
+    has_escaped_quotes = false;
+  }
+}
+
+void csv_reader::add_field(csv_row& row,
+                           usize start,
+                           usize end,
+                           bool quoted,
+                           bool has_escaped_quotes) {
+  if (!quoted) {
+    row.m_fields.add(m_data.substr(start, end - start));
+    return;
+  }
+
+  // Without the quotes, end being the closing one
+  std::string_view field = m_data.substr(start + 1, end - start - 1);
+  if (!has_escaped_quotes) {
+    row.m_fields.add(field);
+    return;
+  }
+
+  // Unescaping only makes the field shorter. If the storage has to grow, the
+  // fields already unescaped in it have to follow.
+  usize offset = m_unescaped.size();
+  if (m_unescaped.capacity() < offset + field.size()) {
+    const char* previous_data = m_unescaped.data();
+    m_unescaped.reserve(2 * (offset + field.size()));
+    for (i32 index : m_unescaped_fields) {
+      auto& previous = row.m_fields[index];
+      previous = {m_unescaped.data() + (previous.data() - previous_data),
+                  previous.size()};
+    }
+  }
+
+  for (usize i = 0; i < field.size(); ++i) {
+    m_unescaped.push_back(field[i]);
+    // Skip the second quote of each pair
+    i += field[i] == m_quote;
+  }
+
+  m_unescaped_fields.add(row.m_fields.element_count());
+  row.m_fields.add({m_unescaped.data() + offset, m_unescaped.size() - offset});
+}
+
+bool csv_reader::refill() {
+  if (m_file == nullptr || m_is_at_end) {
+    return false;
+  }
+
+  // Keep the record that is being read, growing the buffer if it already
+  // fills all of it
+  usize remaining = m_data.size() - m_position;
+  if (remaining == m_buffer.size()) {
+    m_buffer.resize(m_buffer.size() * 2);
+  }
+  memmove(m_buffer.data(), m_buffer.data() + m_position, remaining);
+
+  usize to_read = m_buffer.size() - remaining;
+  usize read = fread(m_buffer.data() + remaining, 1, to_read, m_file);
+  if (read < to_read) {
+    if (ferror(m_file) != 0) {
+      m_has_error = true;
+      return false;
+    }
+    m_is_at_end = true;
+  }
+
+  m_data = {m_buffer.data(), remaining + read};
+  m_position = 0;
+  m_scanner = {m_data, &m_special_characters};
+  return true;
+}
+}  // namespace beard::fmt
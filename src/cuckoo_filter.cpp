@@ -0,0 +1,204 @@
+#include "beard/containers/cuckoo_filter.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace beard {
+namespace {
+constexpr i32 MAX_KICKS = 500;
+constexpr i32 BATCH_SIZE = 16;
+constexpr f64 MAX_LOAD_FACTOR = 0.95;
+}  // namespace
+
+cuckoo_filter::cuckoo_filter(u64 expected_element_count,
+                             f64 false_positive_rate) {
+  // With 4 slots per bucket and 2 buckets per key, a lookup compares against
+  // 8 fingerprints: the false positive rate is about 8 / 2^bits
+  f64 bits = std::ceil(std::log2(8.0 / false_positive_rate));
+  m_fingerprint_bits = bits < 4.0    ? 4
+                       : bits > 16.0 ? 16
+                                     : static_cast<u32>(bits);
+  m_fingerprint_mask = static_cast<u16>((u32{1} << m_fingerprint_bits) - 1);
+
+  // Partial key cuckoo hashing needs a power of two bucket count
+  f64 slots = static_cast<f64>(expected_element_count) / MAX_LOAD_FACTOR;
+  u64 wanted = static_cast<u64>(std::ceil(slots / 4.0));
+  u64 bucket_count = 1;
+  while (bucket_count < wanted) {
+    bucket_count *= 2;
+  }
+
+  m_bucket_mask = bucket_count - 1;
+  m_buckets.resize(static_cast<i32>(bucket_count));
+  clear();
+}
+
+bool cuckoo_filter::insert(u64 bucket, u16 fingerprint) {
+  u64& b = m_buckets[static_cast<i32>(bucket)];
+  for (u32 lane = 0; lane < 64; lane += 16) {
+    if (((b >> lane) & 0xffff) == 0) {
+      b |= u64{fingerprint} << lane;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cuckoo_filter::erase(u64 bucket, u16 fingerprint) {
+  u64& b = m_buckets[static_cast<i32>(bucket)];
+  for (u32 lane = 0; lane < 64; lane += 16) {
+    if (((b >> lane) & 0xffff) == fingerprint) {
+      b &= ~(u64{0xffff} << lane);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cuckoo_filter::add_hash(u64 hash) {
+  // Once an element has been kicked out for good, the filter is full
+  if (m_buckets.is_empty() || m_has_victim) {
+    return false;
+  }
+
+  auto [first, second, fingerprint] = locate(hash);
+  ++m_element_count;
+  if (insert(first, fingerprint) || insert(second, fingerprint)) {
+    return true;
+  }
+
+  auto next_random = [this] {
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 7;
+    m_random_state ^= m_random_state << 17;
+    return m_random_state;
+  };
+
+  // Both buckets are full: evict a random fingerprint and move it to its
+  // other bucket, until everyone finds a place
+  u64 bucket = (next_random() & 1) ? first : second;
+  for (i32 kick = 0; kick < MAX_KICKS; ++kick) {
+    u32 lane = static_cast<u32>(next_random() & 3) * 16;
+    u64& b = m_buckets[static_cast<i32>(bucket)];
+    u16 evicted = static_cast<u16>(b >> lane);
+    b = (b & ~(u64{0xffff} << lane)) | (u64{fingerprint} << lane);
+    fingerprint = evicted;
+
+    bucket = alternate_bucket(bucket, fingerprint);
+    if (insert(bucket, fingerprint)) {
+      return true;
+    }
+  }
+
+  m_has_victim = true;
+  m_victim_bucket = bucket;
+  m_victim_fingerprint = fingerprint;
+  return true;
+}
+
+bool cuckoo_filter::remove_hash(u64 hash) {
+  if (m_buckets.is_empty()) {
+    return false;
+  }
+
+  auto [first, second, fingerprint] = locate(hash);
+  if (erase(first, fingerprint) || erase(second, fingerprint)) {
+    --m_element_count;
+
+    // Some room has been made, try to put the victim back in the table
+    if (m_has_victim) {
+      u64 other = alternate_bucket(m_victim_bucket, m_victim_fingerprint);
+      if (insert(m_victim_bucket, m_victim_fingerprint) ||
+          insert(other, m_victim_fingerprint)) {
+        m_has_victim = false;
+      }
+    }
+    return true;
+  }
+
+  if (m_has_victim && m_victim_fingerprint == fingerprint &&
+      (m_victim_bucket == first || m_victim_bucket == second)) {
+    m_has_victim = false;
+    --m_element_count;
+    return true;
+  }
+
+  return false;
+}
+
+i32 cuckoo_filter::add_all(std::span<const std::string_view> keys) {
+  i32 added = 0;
+  u64 hashes[BATCH_SIZE];
+  for (usize start = 0; start < keys.size(); start += BATCH_SIZE) {
+    usize count = keys.size() - start < BATCH_SIZE ? keys.size() - start
+                                                   : BATCH_SIZE;
+    for (usize i = 0; i < count; ++i) {
+      hashes[i] = hash64::hash(keys[start + i]);
+      if (!m_buckets.is_empty()) {
+        auto [first, second, fingerprint] = locate(hashes[i]);
+        BEARD_PREFETCH(&m_buckets[static_cast<i32>(first)]);
+        BEARD_PREFETCH(&m_buckets[static_cast<i32>(second)]);
+      }
+    }
+    for (usize i = 0; i < count; ++i) {
+      added += add_hash(hashes[i]);
+    }
+  }
+  return added;
+}
+
+void cuckoo_filter::contains_all(std::span<const std::string_view> keys,
+                                 array<u8>& results) const {
+  results.resize(static_cast<i32>(keys.size()));
+  if (m_buckets.is_empty()) {
+    memset(results.data(), 0, keys.size());
+    return;
+  }
+
+  u64 hashes[BATCH_SIZE];
+  for (usize start = 0; start < keys.size(); start += BATCH_SIZE) {
+    usize count = keys.size() - start < BATCH_SIZE ? keys.size() - start
+                                                   : BATCH_SIZE;
+    for (usize i = 0; i < count; ++i) {
+      hashes[i] = hash64::hash(keys[start + i]);
+      auto [first, second, fingerprint] = locate(hashes[i]);
+      BEARD_PREFETCH(&m_buckets[static_cast<i32>(first)]);
+      BEARD_PREFETCH(&m_buckets[static_cast<i32>(second)]);
+    }
+    for (usize i = 0; i < count; ++i) {
+      results[static_cast<i32>(start + i)] = contains_hash(hashes[i]);
+    }
+  }
+}
+
+i32 cuckoo_filter::remove_all(std::span<const std::string_view> keys) {
+  if (m_buckets.is_empty()) {
+    return 0;
+  }
+
+  i32 removed = 0;
+  u64 hashes[BATCH_SIZE];
+  for (usize start = 0; start < keys.size(); start += BATCH_SIZE) {
+    usize count = keys.size() - start < BATCH_SIZE ? keys.size() - start
+                                                   : BATCH_SIZE;
+    for (usize i = 0; i < count; ++i) {
+      hashes[i] = hash64::hash(keys[start + i]);
+      auto [first, second, fingerprint] = locate(hashes[i]);
+      BEARD_PREFETCH(&m_buckets[static_cast<i32>(first)]);
+      BEARD_PREFETCH(&m_buckets[static_cast<i32>(second)]);
+    }
+    for (usize i = 0; i < count; ++i) {
+      removed += remove_hash(hashes[i]);
+    }
+  }
+  return removed;
+}
+
+void cuckoo_filter::clear() {
+  if (!m_buckets.is_empty()) {
+    memset(m_buckets.data(), 0, m_buckets.data_size());
+  }
+  m_element_count = 0;
+  m_has_victim = false;
+}
+}  // namespace beard
@@ -0,0 +1,354 @@
+#include "beard/io/directory_scanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+
+#if BEARD_PLATFORM_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace beard::io {
+namespace {
+char to_lower(char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+
+bool equals_ignoring_case(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (usize i = 0; i < a.size(); ++i) {
+    if (to_lower(a[i]) != to_lower(b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string_view extension_of(std::string_view name) {
+  usize dot = name.find_last_of('.');
+  if (dot == std::string_view::npos || dot == 0) {
+    return {};
+  }
+  return name.substr(dot + 1);
+}
+
+class file_filter {
+ public:
+  explicit file_filter(const scan_options& options)
+      : m_pattern{options.pattern}, m_skip_hidden{options.skip_hidden} {
+    for (std::string_view extension : options.extensions) {
+      if (extension.starts_with('.')) {
+        extension.remove_prefix(1);
+      }
+      m_extensions.add(extension);
+    }
+  }
+
+  bool is_skipped(std::string_view name) const {
+    return m_skip_hidden && name.starts_with('.');
+  }
+
+  bool accepts(std::string_view name) const {
+    if (!m_extensions.is_empty()) {
+      std::string_view extension = extension_of(name);
+      if (std::none_of(m_extensions.begin(), m_extensions.end(),
+                       [&](std::string_view e) {
+                         return equals_ignoring_case(e, extension);
+                       })) {
+        return false;
+      }
+    }
+    return m_pattern.empty() || match_pattern(name, m_pattern);
+  }
+
+ private:
+  beard::array<std::string_view> m_extensions;
+  std::string_view m_pattern;
+  bool m_skip_hidden;
+};
+
+// parent/name in the arena, null terminated so that it can be opened
+std::string_view join_path(arena& strings,
+                           std::string_view parent,
+                           std::string_view name) {
+  bool needs_separator =
+      !parent.empty() && parent.back() != '/' && !name.empty();
+  usize size = parent.size() + needs_separator + name.size();
+  auto path = static_cast<char*>(strings.allocate(size + 1, 1));
+  memcpy(path, parent.data(), parent.size());
+  if (needs_separator) {
+    path[parent.size()] = '/';
+  }
+  if (!name.empty()) {
+    memcpy(path + size - name.size(), name.data(), name.size());
+  }
+  path[size] = '\0';
+  return {path, size};
+}
+
+#if BEARD_PLATFORM_LINUX
+constexpr usize DIRENT_BUFFER_SIZE = KB(usize{64});
+
+i64 to_write_time(const timespec& time) {
+  using namespace std::chrono;
+  sys_time<nanoseconds> sys_time{seconds{time.tv_sec} +
+                                 nanoseconds{time.tv_nsec}};
+  return time_point_cast<std::filesystem::file_time_type::duration>(
+             file_clock::from_sys(sys_time))
+      .time_since_epoch()
+      .count();
+}
+
+// Directories waiting to be read, spread over the workers
+struct scan_state {
+  std::mutex mutex;
+  std::condition_variable has_work;
+  std::deque<std::string_view> pending;
+  i32 active_count = 0;
+};
+
+struct worker_result {
+  arena strings{MB(usize{1})};
+  beard::array<directory_entry> entries;
+  i32 error_count = 0;
+};
+
+void read_directory(std::string_view directory,
+                    const file_filter& filter,
+                    bool stat_files,
+                    char* buffer,
+                    worker_result& result,
+                    beard::array<std::string_view>& subdirectories) {
+  i32 fd = openat(AT_FDCWD, directory.data(),
+                  O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    ++result.error_count;
+    return;
+  }
+  defer(::close(fd));
+
+  while (true) {
+    long size = syscall(SYS_getdents64, fd, buffer, DIRENT_BUFFER_SIZE);
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ++result.error_count;
+      return;
+    }
+    if (size == 0) {
+      return;
+    }
+
+    for (long offset = 0; offset < size;) {
+      auto entry = reinterpret_cast<const dirent64*>(buffer + offset);
+      offset += entry->d_reclen;
+
+      std::string_view name = entry->d_name;
+      if (name == "." || name == ".." || filter.is_skipped(name)) {
+        continue;
+      }
+
+      // Only some file systems give the type, and links have to be resolved
+      u8 type = entry->d_type;
+      struct stat status;
+      bool has_status = false;
+      if (type == DT_UNKNOWN) {
+        if (fstatat(fd, entry->d_name, &status, AT_SYMLINK_NOFOLLOW) != 0) {
+          continue;
+        }
+        type = S_ISDIR(status.st_mode)   ? DT_DIR
+               : S_ISREG(status.st_mode) ? DT_REG
+               : S_ISLNK(status.st_mode) ? DT_LNK
+                                         : DT_UNKNOWN;
+        has_status = true;
+      }
+      if (type == DT_LNK) {
+        if (fstatat(fd, entry->d_name, &status, 0) != 0 ||
+            !S_ISREG(status.st_mode)) {
+          continue;
+        }
+        type = DT_REG;
+        has_status = true;
+      }
+
+      if (type == DT_DIR) {
+        subdirectories.add(join_path(result.strings, directory, name));
+        continue;
+      }
+      if (type != DT_REG || !filter.accepts(name)) {
+        continue;
+      }
+
+      if (stat_files && !has_status) {
+        if (fstatat(fd, entry->d_name, &status, AT_SYMLINK_NOFOLLOW) != 0) {
+          continue;
+        }
+        has_status = true;
+      }
+      result.entries.add(
+          {join_path(result.strings, directory, name),
+           has_status ? static_cast<u64>(status.st_size) : 0,
+           has_status ? to_write_time(status.st_mtim) : 0});
+    }
+  }
+}
+
+void run_worker(scan_state& state,
+                const file_filter& filter,
+                bool stat_files,
+                worker_result& result) {
+  auto buffer = std::make_unique_for_overwrite<char[]>(DIRENT_BUFFER_SIZE);
+  beard::array<std::string_view> subdirectories;
+
+  while (true) {
+    std::string_view directory;
+    {
+      std::unique_lock lock{state.mutex};
+      state.has_work.wait(lock, [&] {
+        return !state.pending.empty() || state.active_count == 0;
+      });
+      if (state.pending.empty()) {
+        return;
+      }
+      // Depth first, the most recent directories are the warmest
+      directory = state.pending.back();
+      state.pending.pop_back();
+      ++state.active_count;
+    }
+
+    subdirectories.clear();
+    read_directory(directory, filter, stat_files, buffer.get(), result,
+                   subdirectories);
+
+    bool should_wake = false;
+    {
+      std::lock_guard lock{state.mutex};
+      state.pending.insert(state.pending.end(), subdirectories.begin(),
+                           subdirectories.end());
+      --state.active_count;
+      should_wake = !subdirectories.is_empty() || state.active_count == 0;
+    }
+    if (should_wake) {
+      state.has_work.notify_all();
+    }
+  }
+}
+#endif
+}  // namespace
+
+std::string_view directory_entry::extension() const {
+  return extension_of(name());
+}
+
+void directory_listing::sort() {
+  std::sort(m_entries.begin(), m_entries.end(),
+            [](const directory_entry& a, const directory_entry& b) {
+              return a.path < b.path;
+            });
+}
+
+directory_listing scan_directory(std::string_view root,
+                                 const scan_options& options,
+                                 thread_pool& pool) {
+  directory_listing listing;
+  file_filter filter{options};
+  if (root.empty()) {
+    root = ".";
+  }
+
+#if BEARD_PLATFORM_LINUX
+  beard::array<worker_result> results;
+  results.resize(pool.thread_count() + 1);
+
+  scan_state state;
+  state.pending.push_back(join_path(results[0].strings, root, {}));
+  pool.parallel_for(results.element_count(), [&](i32 i) {
+    run_worker(state, filter, options.stat_files, results[i]);
+  });
+
+  i32 entry_count = 0;
+  for (const worker_result& result : results) {
+    entry_count += result.entries.element_count();
+  }
+  listing.m_entries.reserve(entry_count);
+  for (worker_result& result : results) {
+    listing.m_entries.append(result.entries);
+    listing.m_arenas.add(std::move(result.strings));
+    listing.m_error_count += result.error_count;
+  }
+#else
+  UNUSED(pool);
+  namespace fs = std::filesystem;
+  listing.m_arenas.add(arena{MB(usize{1})});
+  arena& strings = listing.m_arenas.last();
+
+  std::error_code error;
+  fs::recursive_directory_iterator it{fs::path{root}, error};
+  if (error) {
+    listing.m_error_count = 1;
+  }
+  for (fs::recursive_directory_iterator end; !error && it != end;
+       it.increment(error)) {
+    std::string name = it->path().filename().generic_string();
+    if (filter.is_skipped(name)) {
+      it.disable_recursion_pending();
+      continue;
+    }
+    if (!it->is_regular_file(error) || !filter.accepts(name)) {
+      error.clear();
+      continue;
+    }
+
+    directory_entry entry = {};
+    entry.path = join_path(strings, it->path().generic_string(), {});
+    if (options.stat_files) {
+      entry.size = it->file_size(error);
+      entry.write_time = it->last_write_time(error).time_since_epoch().count();
+      error.clear();
+    }
+    listing.m_entries.add(entry);
+  }
+  if (error) {
+    ++listing.m_error_count;
+  }
+#endif
+
+  return listing;
+}
+
+bool match_pattern(std::string_view name, std::string_view pattern) {
+  // Greedy matching, going back to the last star on a mismatch
+  usize n = 0;
+  usize p = 0;
+  usize star = std::string_view::npos;
+  usize star_match = 0;
+  while (n < name.size()) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+      ++n;
+      ++p;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      star_match = n;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      n = ++star_match;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+}  // namespace beard::io
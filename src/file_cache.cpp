@@ -0,0 +1,215 @@
+#include "beard/io/file_cache.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+#include "beard/misc/hash.h"
+
+namespace beard::io {
+namespace {
+namespace fs = std::filesystem;
+
+// "BRFC"
+constexpr u32 MAGIC = 0x43465242;
+constexpr u32 VERSION = 1;
+
+struct header {
+  u32 magic;
+  u32 version;
+  u64 entry_count;
+};
+
+// Write times this close to the recording may be followed by another write
+// with the same timestamp
+constexpr i64 RACY_WINDOW =
+    std::chrono::duration_cast<fs::file_time_type::duration>(
+        std::chrono::seconds{2})
+        .count();
+
+i64 now() {
+  return fs::file_time_type::clock::now().time_since_epoch().count();
+}
+
+std::string index_path(std::string_view directory) {
+  return std::string{directory} + "/index.bin";
+}
+}  // namespace
+
+file_cache::file_cache(std::string_view directory) : m_directory{directory} {
+  std::error_code error;
+  fs::create_directories(m_directory, error);
+}
+
+file_cache::~file_cache() {
+  if (m_is_dirty) {
+    save();
+  }
+}
+
+bool file_cache::load() {
+  m_entries.clear();
+  m_is_dirty = false;
+
+  std::string bytes = read_whole_file(index_path(m_directory));
+  if (bytes.size() < sizeof(header)) {
+    return false;
+  }
+
+  header h;
+  memcpy(&h, bytes.data(), sizeof(h));
+  if (h.magic != MAGIC || h.version != VERSION) {
+    return false;
+  }
+
+  usize position = sizeof(h);
+  for (u64 i = 0; i < h.entry_count; ++i) {
+    u32 path_size;
+    if (bytes.size() - position < sizeof(path_size)) {
+      m_entries.clear();
+      return false;
+    }
+    memcpy(&path_size, bytes.data() + position, sizeof(path_size));
+    position += sizeof(path_size);
+
+    if (bytes.size() - position < u64{path_size} + sizeof(entry)) {
+      m_entries.clear();
+      return false;
+    }
+    std::string path = bytes.substr(position, path_size);
+    position += path_size;
+
+    entry e;
+    memcpy(&e, bytes.data() + position, sizeof(e));
+    position += sizeof(e);
+    m_entries.add(std::move(path), std::move(e));
+  }
+  return true;
+}
+
+bool file_cache::save() {
+  header h = {MAGIC, VERSION, static_cast<u64>(m_entries.element_count())};
+
+  usize size = sizeof(h);
+  for (const auto& [path, e] : m_entries) {
+    size += sizeof(u32) + path.size() + sizeof(e);
+  }
+
+  std::string bytes;
+  bytes.reserve(size);
+  bytes.append(reinterpret_cast<const char*>(&h), sizeof(h));
+  for (const auto& [path, e] : m_entries) {
+    u32 path_size = static_cast<u32>(path.size());
+    bytes.append(reinterpret_cast<const char*>(&path_size), sizeof(path_size));
+    bytes.append(path);
+    bytes.append(reinterpret_cast<const char*>(&e), sizeof(e));
+  }
+
+  if (!write_whole_file_atomic(index_path(m_directory), bytes)) {
+    return false;
+  }
+  m_is_dirty = false;
+  return true;
+}
+
+beard::optional<std::string> file_cache::find(std::string_view path) {
+  auto found = m_entries.find(std::string{path});
+  if (found == m_entries.end() || !is_unchanged(path, found->second)) {
+    return {};
+  }
+
+  // The artifact may have been deleted behind our back
+  std::string artifact = artifact_path(path);
+  std::error_code error;
+  if (!fs::is_regular_file(artifact, error)) {
+    return {};
+  }
+  return read_whole_file(artifact);
+}
+
+bool file_cache::store(std::string_view path, std::string_view artifact) {
+  auto state = stat_file(path);
+  if (!state.has_value()) {
+    return false;
+  }
+  return store(path, state.value(), read_whole_file(path), artifact);
+}
+
+bool file_cache::store(std::string_view path,
+                       const file_state& state,
+                       std::string_view content,
+                       std::string_view artifact) {
+  if (!write_whole_file_atomic(artifact_path(path), artifact)) {
+    return false;
+  }
+
+  entry e;
+  e.size = state.size;
+  e.write_time = state.write_time;
+  e.record_time = now();
+  e.content_hash = hash64::hash(content);
+  m_entries.add(std::string{path}, std::move(e));
+  m_is_dirty = true;
+  return true;
+}
+
+void file_cache::remove(std::string_view path) {
+  if (m_entries.remove(std::string{path})) {
+    m_is_dirty = true;
+  }
+
+  std::error_code error;
+  fs::remove(artifact_path(path), error);
+}
+
+beard::optional<file_cache::file_state> file_cache::stat_file(
+    std::string_view path) {
+  fs::path file_path{path};
+  std::error_code error;
+  u64 size = fs::file_size(file_path, error);
+  if (error) {
+    return {};
+  }
+  auto write_time = fs::last_write_time(file_path, error);
+  if (error) {
+    return {};
+  }
+  return file_state{size, write_time.time_since_epoch().count()};
+}
+
+bool file_cache::is_unchanged(std::string_view path, entry& recorded) {
+  auto state = stat_file(path);
+  if (!state.has_value() || state.value().size != recorded.size) {
+    return false;
+  }
+
+  if (state.value().write_time == recorded.write_time &&
+      recorded.write_time < recorded.record_time - RACY_WINDOW) {
+    return true;
+  }
+
+  std::string content = read_whole_file(path);
+  if (content.size() != recorded.size ||
+      hash64::hash(content) != recorded.content_hash) {
+    return false;
+  }
+
+  // Touched but not modified, no need to hash it again next time
+  recorded.write_time = state.value().write_time;
+  recorded.record_time = now();
+  m_is_dirty = true;
+  return true;
+}
+
+std::string file_cache::artifact_path(std::string_view path) const {
+  char name[16];
+  auto result =
+      std::to_chars(name, name + sizeof(name), hash64::hash(path), 16);
+  std::string artifact_path = m_directory;
+  artifact_path += '/';
+  artifact_path.append(name, result.ptr);
+  artifact_path += ".artifact";
+  return artifact_path;
+}
+}  // namespace beard::io
@@ -0,0 +1,168 @@
+#include "beard/io/file_stream_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if BEARD_PLATFORM_LINUX
+#include <fcntl.h>
+#endif
+
+namespace beard::io {
+file_stream_reader::file_stream_reader(usize chunk_size, i32 buffer_count)
+    : m_chunk_size{std::max<usize>(chunk_size, 1)},
+      m_carry_over_capacity{m_chunk_size / 4} {
+  // One buffer is processed while the others are read
+  m_buffers.resize(std::max(buffer_count, 2));
+}
+
+file_stream_reader::~file_stream_reader() { close(); }
+
+bool file_stream_reader::open(std::string_view filename) {
+  close();
+
+  std::string path{filename};
+  m_file = fopen(path.c_str(), "rb");
+  if (m_file == nullptr) {
+    return false;
+  }
+  // Chunks are big enough, stdio buffering would only add a copy
+  setvbuf(m_file, nullptr, _IONBF, 0);
+#if BEARD_PLATFORM_LINUX
+  posix_fadvise(fileno(m_file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  for (i32 i = 0; i < m_buffers.element_count(); ++i) {
+    if (m_buffers[i].memory == nullptr) {
+      m_buffers[i].memory = std::make_unique_for_overwrite<char[]>(
+          m_carry_over_capacity + m_chunk_size);
+    }
+    m_free.push_back(i);
+  }
+
+  m_is_reading_done = false;
+  m_is_stopping = false;
+  m_has_error = false;
+  m_is_at_end = false;
+  m_thread = std::thread{[this] { read_ahead(); }};
+  return true;
+}
+
+void file_stream_reader::close() {
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard lock{m_mutex};
+      m_is_stopping = true;
+    }
+    m_has_free.notify_one();
+    m_thread.join();
+  }
+
+  if (m_file != nullptr) {
+    fclose(m_file);
+    m_file = nullptr;
+  }
+
+  m_filled.clear();
+  m_free.clear();
+  m_current = -1;
+  m_chunk = {};
+  m_is_at_end = true;
+}
+
+void file_stream_reader::read_ahead() {
+  while (true) {
+    i32 index;
+    {
+      std::unique_lock lock{m_mutex};
+      m_has_free.wait(lock,
+                      [this] { return m_is_stopping || !m_free.empty(); });
+      if (m_is_stopping) {
+        return;
+      }
+      index = m_free.front();
+      m_free.pop_front();
+    }
+
+    chunk_buffer& buffer = m_buffers[index];
+    buffer.size = fread(buffer.memory.get() + m_carry_over_capacity, 1,
+                        m_chunk_size, m_file);
+    bool is_done = buffer.size < m_chunk_size;
+
+    {
+      std::lock_guard lock{m_mutex};
+      m_filled.push_back(index);
+      if (is_done) {
+        m_has_error = ferror(m_file) != 0;
+        m_is_reading_done = true;
+      }
+    }
+    m_has_filled.notify_one();
+
+    if (is_done) {
+      return;
+    }
+  }
+}
+
+std::span<const char> file_stream_reader::next_chunk(usize carry_over) {
+  if (m_is_at_end) {
+    return {};
+  }
+
+  ASSERT(carry_over <= m_chunk.size(), "Carrying over more than the chunk");
+  carry_over = std::min(carry_over, m_chunk.size());
+  const char* tail = m_chunk.data() + m_chunk.size() - carry_over;
+
+  i32 next = -1;
+  {
+    std::unique_lock lock{m_mutex};
+    m_has_filled.wait(
+        lock, [this] { return !m_filled.empty() || m_is_reading_done; });
+    if (!m_filled.empty()) {
+      next = m_filled.front();
+      m_filled.pop_front();
+    }
+  }
+
+  // The tail may live in the chunk that is given back below, or in
+  // m_long_carry_over itself
+  std::span<const char> chunk;
+  if (next < 0 || m_buffers[next].size == 0) {
+    m_is_at_end = true;
+    m_long_carry_over.assign(tail, carry_over);
+    chunk = {m_long_carry_over.data(), m_long_carry_over.size()};
+  } else if (carry_over <= m_carry_over_capacity) {
+    char* data = m_buffers[next].memory.get() + m_carry_over_capacity;
+    if (carry_over > 0) {
+      memcpy(data - carry_over, tail, carry_over);
+    }
+    chunk = {data - carry_over, carry_over + m_buffers[next].size};
+  } else {
+    std::string long_carry_over;
+    long_carry_over.reserve(carry_over + m_buffers[next].size);
+    long_carry_over.assign(tail, carry_over);
+    long_carry_over.append(
+        m_buffers[next].memory.get() + m_carry_over_capacity,
+        m_buffers[next].size);
+    m_long_carry_over = std::move(long_carry_over);
+    chunk = {m_long_carry_over.data(), m_long_carry_over.size()};
+  }
+
+  // Hand the previous buffer back to the thread, along with the next one
+  // when its contents were copied
+  {
+    std::lock_guard lock{m_mutex};
+    if (m_current >= 0) {
+      m_free.push_back(m_current);
+    }
+    m_current = chunk.data() == m_long_carry_over.data() ? -1 : next;
+    if (next >= 0 && m_current != next) {
+      m_free.push_back(next);
+    }
+  }
+  m_has_free.notify_one();
+
+  m_chunk = chunk;
+  return chunk;
+}
+}  // namespace beard::io
@@ -0,0 +1,150 @@
+#include "beard/fmt/fmt.h"
+
+#include <cstring>
+
+#include "beard/core/cpu.h"
+
+#if BEARD_HAS_SSE2
+#include <immintrin.h>
+#endif
+
+namespace beard::fmt {
+struct delimiter_set_kernels {
+  static u64 match_block_scalar(const delimiter_set& set, const char* block) {
+    u64 mask = 0;
+    for (usize i = 0; i < delimiter_set::BLOCK_SIZE; ++i) {
+      mask |= u64{set.contains(block[i])} << i;
+    }
+    return mask;
+  }
+
+#if BEARD_HAS_SSE2
+  // Exact lookup of each byte in the 256 bits bitmap: pshufb on the low
+  // nibble fetches the row, and only keeps it from the table matching the
+  // high bit of the byte (pshufb zeroes lanes whose index has the high bit
+  // set). A second pshufb on the high nibble gives the bit to test.
+  BEARD_TARGET("ssse3,sse4.2")
+  static u64 match_block_sse42(const delimiter_set& set, const char* block) {
+    const __m128i low_table = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(set.m_low_table));
+    const __m128i high_table = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(set.m_high_table));
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4,
+                                       8, 16, 32, 64, -128);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i high_bit = _mm_set1_epi8(-128);
+    const __m128i single = _mm_set1_epi8(set.m_single);
+
+    u64 mask = 0;
+    for (usize i = 0; i < delimiter_set::BLOCK_SIZE; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+      __m128i matches;
+      if (set.m_is_single) {
+        matches = _mm_cmpeq_epi8(v, single);
+      } else {
+        __m128i row = _mm_or_si128(
+            _mm_shuffle_epi8(low_table, v),
+            _mm_shuffle_epi8(high_table, _mm_xor_si128(v, high_bit)));
+        __m128i bit =
+            _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        matches = _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+      }
+      mask |= static_cast<u64>(static_cast<u32>(_mm_movemask_epi8(matches)))
+              << i;
+    }
+    return mask;
+  }
+
+  BEARD_TARGET("avx2")
+  static u64 match_block_avx2(const delimiter_set& set, const char* block) {
+    const __m256i low_table = _mm256_broadcastsi128_si256(_mm_load_si128(
+        reinterpret_cast<const __m128i*>(set.m_low_table)));
+    const __m256i high_table = _mm256_broadcastsi128_si256(_mm_load_si128(
+        reinterpret_cast<const __m128i*>(set.m_high_table)));
+    const __m256i bits = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8,
+        16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i high_bit = _mm256_set1_epi8(-128);
+    const __m256i single = _mm256_set1_epi8(set.m_single);
+
+    u64 mask = 0;
+    for (usize i = 0; i < delimiter_set::BLOCK_SIZE; i += 32) {
+      __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+      __m256i matches;
+      if (set.m_is_single) {
+        matches = _mm256_cmpeq_epi8(v, single);
+      } else {
+        __m256i row = _mm256_or_si256(
+            _mm256_shuffle_epi8(low_table, v),
+            _mm256_shuffle_epi8(high_table, _mm256_xor_si256(v, high_bit)));
+        __m256i bit = _mm256_shuffle_epi8(
+            bits, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        matches = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+      }
+      mask |= static_cast<u64>(static_cast<u32>(_mm256_movemask_epi8(matches)))
+              << i;
+    }
+    return mask;
+  }
+#endif
+
+  using match_block_fn = u64 (*)(const delimiter_set&, const char*);
+
+  static match_block_fn select() {
+#if BEARD_HAS_SSE2
+    const auto& cpu = get_cpu_features();
+    if (cpu.avx2) {
+      return match_block_avx2;
+    }
+    if (cpu.sse42) {
+      return match_block_sse42;
+    }
+#endif
+    return match_block_scalar;
+  }
+};
+
+delimiter_set::delimiter_set(std::string_view delimiters) {
+  for (char c : delimiters) {
+    u8 byte = static_cast<u8>(c);
+    u8* table = byte < 0x80 ? m_low_table : m_high_table;
+    table[byte & 15] |= static_cast<u8>(1u << ((byte >> 4) & 7));
+  }
+
+  // Only the number of different characters matters
+  m_is_single = !delimiters.empty() &&
+                delimiters.find_first_not_of(delimiters[0]) ==
+                    std::string_view::npos;
+  m_single = m_is_single ? delimiters[0] : 0;
+
+  local_variable const auto kernel = delimiter_set_kernels::select();
+  m_match_block = kernel;
+}
+
+u64 delimiter_set::match_block(const char* block) const {
+  return m_match_block(*this, block);
+}
+
+u64 delimiter_set::match_partial_block(const char* block, usize size) const {
+  ASSERT(size <= BLOCK_SIZE, "Partial block is bigger than a block");
+  char padded[BLOCK_SIZE] = {};
+  memcpy(padded, block, size);
+  u64 mask = match_block(padded);
+  return size == BLOCK_SIZE ? mask : mask & ((u64{1} << size) - 1);
+}
+
+usize delimiter_set::find_first(std::string_view text, usize from) const {
+  for (usize start = from; start < text.size(); start += BLOCK_SIZE) {
+    usize remaining = text.size() - start;
+    u64 mask = remaining >= BLOCK_SIZE
+                   ? match_block(text.data() + start)
+                   : match_partial_block(text.data() + start, remaining);
+    if (mask != 0) {
+      return start + std::countr_zero(mask);
+    }
+  }
+  return std::string_view::npos;
+}
+}  // namespace beard::fmt
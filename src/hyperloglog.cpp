@@ -0,0 +1,202 @@
+#include "beard/misc/hyperloglog.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace beard {
+namespace {
+constexpr i32 SPARSE_BUFFER_SIZE = 256;
+
+u32 sparse_entry(u64 hash) {
+  constexpr u32 p = hyperloglog::SPARSE_PRECISION;
+  u64 rest = hash << p;
+  u32 rank = rest == 0 ? 64 - p + 1 : std::countl_zero(rest) + 1;
+  return static_cast<u32>(hash >> (64 - p)) << 6 | rank;
+}
+
+// Sort and only keep the highest rank of each index
+void normalize(array<u32>& entries) {
+  std::sort(entries.begin(), entries.end());
+
+  i32 count = 0;
+  for (i32 i = 0; i < entries.element_count(); ++i) {
+    bool last_of_index = i + 1 == entries.element_count() ||
+                         (entries[i] >> 6) != (entries[i + 1] >> 6);
+    if (last_of_index) {
+      entries[count++] = entries[i];
+    }
+  }
+  entries.resize(count);
+}
+
+f64 sigma(f64 x) {
+  if (x == 1.0) {
+    return std::numeric_limits<f64>::infinity();
+  }
+
+  f64 y = 1.0;
+  f64 z = x;
+  f64 previous;
+  do {
+    x *= x;
+    previous = z;
+    z += x * y;
+    y += y;
+  } while (z != previous);
+  return z;
+}
+
+f64 tau(f64 x) {
+  if (x == 0.0 || x == 1.0) {
+    return 0.0;
+  }
+
+  f64 y = 1.0;
+  f64 z = 1.0 - x;
+  f64 previous;
+  do {
+    x = std::sqrt(x);
+    previous = z;
+    y *= 0.5;
+    z -= (1.0 - x) * (1.0 - x) * y;
+  } while (z != previous);
+  return z / 3.0;
+}
+}  // namespace
+
+hyperloglog::hyperloglog(u32 precision)
+    : m_precision{std::clamp(precision, MIN_PRECISION, MAX_PRECISION)} {}
+
+void hyperloglog::add_hash(u64 hash) {
+  if (is_sparse()) {
+    m_sparse_buffer.add(sparse_entry(hash));
+    if (m_sparse_buffer.element_count() >= SPARSE_BUFFER_SIZE) {
+      flush_sparse_buffer();
+    }
+    return;
+  }
+
+  u32 index = static_cast<u32>(hash >> (64 - m_precision));
+  u64 rest = hash << m_precision;
+  u8 rank = static_cast<u8>(rest == 0 ? 64 - m_precision + 1
+                                      : std::countl_zero(rest) + 1);
+  u8& reg = m_registers[static_cast<i32>(index)];
+  reg = rank > reg ? rank : reg;
+}
+
+f64 hyperloglog::estimate() const {
+  if (!is_sparse()) {
+    return estimate_dense();
+  }
+
+  array<u32> entries = m_sparse;
+  entries.append(m_sparse_buffer);
+  normalize(entries);
+
+  // Linear counting on the sparse registers, which is very precise as long
+  // as most of them are empty, which is the case until we go dense
+  f64 m = static_cast<f64>(u64{1} << SPARSE_PRECISION);
+  f64 empty = m - entries.element_count();
+  return m * std::log(m / empty);
+}
+
+f64 hyperloglog::estimate_dense() const {
+  u32 q = 64 - m_precision;
+  u32 histogram[64 + 2] = {};
+  for (u8 reg : m_registers) {
+    ++histogram[reg];
+  }
+
+  f64 m = static_cast<f64>(m_registers.element_count());
+  f64 z = m * tau(1.0 - histogram[q + 1] / m);
+  for (u32 k = q; k >= 1; --k) {
+    z = 0.5 * (z + histogram[k]);
+  }
+  z += m * sigma(histogram[0] / m);
+
+  constexpr f64 alpha = 0.5 / 0.69314718055994530942;
+  return alpha * m * m / z;
+}
+
+bool hyperloglog::merge(const hyperloglog& other) {
+  if (other.m_precision != m_precision) {
+    return false;
+  }
+
+  if (is_sparse() && other.is_sparse()) {
+    m_sparse.append(other.m_sparse);
+    m_sparse.append(other.m_sparse_buffer);
+    flush_sparse_buffer();
+    return true;
+  }
+
+  if (is_sparse()) {
+    convert_to_dense();
+  }
+
+  if (other.is_sparse()) {
+    for (u32 entry : other.m_sparse) {
+      add_sparse_entry_to_dense(entry);
+    }
+    for (u32 entry : other.m_sparse_buffer) {
+      add_sparse_entry_to_dense(entry);
+    }
+  } else {
+    for (i32 i = 0; i < m_registers.element_count(); ++i) {
+      m_registers[i] = std::max(m_registers[i], other.m_registers[i]);
+    }
+  }
+
+  return true;
+}
+
+void hyperloglog::clear() {
+  m_sparse.clear();
+  m_sparse_buffer.clear();
+  m_registers.clear();
+}
+
+usize hyperloglog::memory_size() const {
+  return m_sparse.data_size() + m_sparse_buffer.data_size() +
+         m_registers.data_size();
+}
+
+void hyperloglog::flush_sparse_buffer() {
+  m_sparse.append(m_sparse_buffer);
+  m_sparse_buffer.clear();
+  normalize(m_sparse);
+
+  // Go dense as soon as the list takes more memory than the registers
+  if (static_cast<u64>(m_sparse.data_size()) > (u64{1} << m_precision)) {
+    convert_to_dense();
+  }
+}
+
+void hyperloglog::convert_to_dense() {
+  m_registers = array<u8>(static_cast<i32>(1u << m_precision), 0);
+  for (u32 entry : m_sparse) {
+    add_sparse_entry_to_dense(entry);
+  }
+  for (u32 entry : m_sparse_buffer) {
+    add_sparse_entry_to_dense(entry);
+  }
+  m_sparse = {};
+  m_sparse_buffer = {};
+}
+
+void hyperloglog::add_sparse_entry_to_dense(u32 entry) {
+  // The bits of the sparse index past the dense precision are the first
+  // bits the dense rank would have looked at
+  u32 extra_bits = SPARSE_PRECISION - m_precision;
+  u32 sparse_index = entry >> 6;
+  u32 index = sparse_index >> extra_bits;
+  u32 low = sparse_index & ((1u << extra_bits) - 1);
+
+  u8 rank = static_cast<u8>(low != 0 ? extra_bits - std::bit_width(low) + 1
+                                     : extra_bits + (entry & 63));
+  u8& reg = m_registers[static_cast<i32>(index)];
+  reg = rank > reg ? rank : reg;
+}
+}  // namespace beard
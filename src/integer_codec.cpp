@@ -0,0 +1,470 @@
+#include "beard/io/integer_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "beard/core/cpu.h"
+
+#if BEARD_HAS_SSE2
+#include <immintrin.h>
+#endif
+
+namespace beard::io {
+using namespace bit_packing;
+
+namespace {
+constexpr usize PACKED_WORD_COUNT = BLOCK_SIZE / 32;
+
+u32 read32(const char* p) {
+  u32 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Decode the varint at p, false if it is truncated or does not fit in T
+template <typename T>
+bool read_one(const u8*& p, const u8* end, T& value) {
+  constexpr u32 MAX_SHIFT = sizeof(T) == 4 ? 28 : 63;
+
+  u64 result = 0;
+  for (u32 shift = 0; p < end && shift <= MAX_SHIFT; shift += 7) {
+    u8 byte = *p++;
+    if (shift == 63 && byte > 1) {
+      return false;
+    }
+    result |= u64{byte & 0x7fu} << shift;
+    if (byte < 0x80) {
+      if (result > std::numeric_limits<T>::max()) {
+        return false;
+      }
+      value = static_cast<T>(result);
+      return true;
+    }
+  }
+  return false;
+}
+
+// output must have room for input.size() values, no varint is shorter than
+// a byte
+template <typename T>
+bool decode_scalar(std::string_view input, T* output, usize* count) {
+  auto p = reinterpret_cast<const u8*>(input.data());
+  auto end = p + input.size();
+  T* out = output;
+  while (p < end) {
+    if (!read_one(p, end, *out++)) {
+      return false;
+    }
+  }
+  *count = out - output;
+  return true;
+}
+
+void unpack_scalar_generic(const char* words,
+                           u32 reference,
+                           u32 bit_count,
+                           u32* output) {
+  if (bit_count == 0) {
+    std::fill(output, output + BLOCK_SIZE, reference);
+    return;
+  }
+  const u32 mask = static_cast<u32>((u64{1} << bit_count) - 1);
+  for (u32 j = 0; j < BLOCK_SIZE / LANE_COUNT; ++j) {
+    u32 bit = j * bit_count;
+    const char* word = words + (bit / 32) * LANE_COUNT * sizeof(u32);
+    u32 shift = bit % 32;
+    for (u32 lane = 0; lane < LANE_COUNT; ++lane) {
+      u32 v = read32(word + lane * sizeof(u32)) >> shift;
+      if (shift + bit_count > 32) {
+        v |= read32(word + (LANE_COUNT + lane) * sizeof(u32)) << (32 - shift);
+      }
+      output[j * LANE_COUNT + lane] = (v & mask) + reference;
+    }
+  }
+}
+
+template <u32 BIT_COUNT>
+void unpack_scalar(const char* words, u32 reference, u32* output) {
+  unpack_scalar_generic(words, reference, BIT_COUNT, output);
+}
+
+u32 prefix_sum_scalar(u32* values, usize count, u32 carry) {
+  for (usize i = 0; i < count; ++i) {
+    carry += values[i];
+    values[i] = carry;
+  }
+  return carry;
+}
+
+#if BEARD_HAS_SSE2
+template <typename T>
+BEARD_TARGET("avx2")
+void widen(__m256i bytes, T* output) {
+  __m128i halves[] = {_mm256_castsi256_si128(bytes),
+                      _mm256_extracti128_si256(bytes, 1)};
+  auto out = reinterpret_cast<__m256i*>(output);
+  for (__m128i half : halves) {
+    if constexpr (sizeof(T) == 4) {
+      _mm256_storeu_si256(out++, _mm256_cvtepu8_epi32(half));
+      _mm256_storeu_si256(out++,
+                          _mm256_cvtepu8_epi32(_mm_srli_si128(half, 8)));
+    } else {
+      _mm256_storeu_si256(out++, _mm256_cvtepu8_epi64(half));
+      _mm256_storeu_si256(out++,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(half, 4)));
+      _mm256_storeu_si256(out++,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(half, 8)));
+      _mm256_storeu_si256(out++,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(half, 12)));
+    }
+  }
+}
+
+// Widen the one byte varints in front of each 32 bytes at once, the others
+// go through read_one
+template <typename T>
+BEARD_TARGET("avx2")
+bool decode_avx2(std::string_view input, T* output, usize* count) {
+  auto p = reinterpret_cast<const u8*>(input.data());
+  auto end = p + input.size();
+  T* out = output;
+  // out is never further than p, so the 32 widened values fit
+  while (end - p >= 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    u32 continuations = static_cast<u32>(_mm256_movemask_epi8(bytes));
+    usize single_count = std::countr_zero(continuations);
+    if (single_count > 0) {
+      widen(bytes, out);
+      p += single_count;
+      out += single_count;
+    }
+    if (continuations != 0 && !read_one(p, end, *out++)) {
+      return false;
+    }
+  }
+  usize tail_count = 0;
+  if (!decode_scalar({reinterpret_cast<const char*>(p),
+                      static_cast<usize>(end - p)},
+                     out, &tail_count)) {
+    return false;
+  }
+  *count = out + tail_count - output;
+  return true;
+}
+
+template <u32 BIT_COUNT>
+BEARD_TARGET("avx2")
+void unpack_avx2(const char* words, u32 reference, u32* output) {
+  const __m256i mask =
+      _mm256_set1_epi32(static_cast<i32>((u64{1} << BIT_COUNT) - 1));
+  const __m256i base = _mm256_set1_epi32(static_cast<i32>(reference));
+  auto in = reinterpret_cast<const __m256i*>(words);
+  auto out = reinterpret_cast<__m256i*>(output);
+  for (u32 j = 0; j < BLOCK_SIZE / LANE_COUNT; ++j) {
+    if constexpr (BIT_COUNT == 0) {
+      _mm256_storeu_si256(out + j, base);
+    } else {
+      const u32 bit = j * BIT_COUNT;
+      const u32 shift = bit % 32;
+      __m256i v = _mm256_srli_epi32(_mm256_loadu_si256(in + bit / 32), shift);
+      if (shift + BIT_COUNT > 32) {
+        v = _mm256_or_si256(
+            v, _mm256_slli_epi32(_mm256_loadu_si256(in + bit / 32 + 1),
+                                 32 - shift));
+      }
+      _mm256_storeu_si256(out + j,
+                          _mm256_add_epi32(_mm256_and_si256(v, mask), base));
+    }
+  }
+}
+
+BEARD_TARGET("avx2")
+u32 prefix_sum_avx2(u32* values, usize count, u32 carry) {
+  __m256i sum = _mm256_set1_epi32(static_cast<i32>(carry));
+  usize i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto p = reinterpret_cast<__m256i*>(values + i);
+    __m256i x = _mm256_loadu_si256(p);
+    // Sums within each 128 bits lane, then the low lane total to the high one
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+    __m256i low_total = _mm256_shuffle_epi32(x, 0xff);
+    x = _mm256_add_epi32(
+        x, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+    x = _mm256_add_epi32(x, sum);
+    _mm256_storeu_si256(p, x);
+    sum = _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+  }
+  if (i > 0) {
+    carry = values[i - 1];
+  }
+  return prefix_sum_scalar(values + i, count - i, carry);
+}
+#endif
+
+using unpack_fn = void (*)(const char*, u32, u32*);
+using unpack_table = std::array<unpack_fn, 33>;
+
+template <u32... BIT_COUNTS>
+constexpr unpack_table scalar_unpackers(
+    std::integer_sequence<u32, BIT_COUNTS...>) {
+  return {unpack_scalar<BIT_COUNTS>...};
+}
+
+#if BEARD_HAS_SSE2
+template <u32... BIT_COUNTS>
+constexpr unpack_table avx2_unpackers(
+    std::integer_sequence<u32, BIT_COUNTS...>) {
+  return {unpack_avx2<BIT_COUNTS>...};
+}
+#endif
+
+struct integer_kernels {
+  bool (*decode32)(std::string_view, u32*, usize*) = decode_scalar<u32>;
+  bool (*decode64)(std::string_view, u64*, usize*) = decode_scalar<u64>;
+  unpack_table unpack =
+      scalar_unpackers(std::make_integer_sequence<u32, 33>{});
+  u32 (*prefix_sum)(u32*, usize, u32) = prefix_sum_scalar;
+};
+
+integer_kernels select_kernels() {
+  integer_kernels kernels;
+#if BEARD_HAS_SSE2
+  if (get_cpu_features().avx2) {
+    kernels.decode32 = decode_avx2<u32>;
+    kernels.decode64 = decode_avx2<u64>;
+    kernels.unpack = avx2_unpackers(std::make_integer_sequence<u32, 33>{});
+    kernels.prefix_sum = prefix_sum_avx2;
+  }
+#endif
+  return kernels;
+}
+
+const integer_kernels& get_kernels() {
+  static const integer_kernels kernels = select_kernels();
+  return kernels;
+}
+
+template <typename T>
+void encode_all(std::span<const T> values, std::string& output) {
+  usize size = output.size();
+  output.resize(size + values.size() * MAX_VARINT_SIZE);
+  for (T value : values) {
+    size += write_varint(value, output.data() + size);
+  }
+  output.resize(size);
+}
+
+template <typename T>
+bool decode_all(std::string_view input,
+                beard::array<T>& values,
+                bool (*decode)(std::string_view, T*, usize*)) {
+  if (input.size() > static_cast<usize>(std::numeric_limits<i32>::max())) {
+    return false;
+  }
+  values.resize(static_cast<i32>(input.size()));
+  usize count = 0;
+  if (!decode(input, values.data(), &count)) {
+    values.clear();
+    return false;
+  }
+  values.resize(static_cast<i32>(count));
+  return true;
+}
+
+template <typename T>
+void delta_encode_all(std::span<T> values) {
+  T previous = 0;
+  for (T& value : values) {
+    T current = value;
+    value -= previous;
+    previous = current;
+  }
+}
+
+void pack_block(const u32* values, u32 reference, u32 bit_count, u32* words) {
+  memset(words, 0, bit_count * LANE_COUNT * sizeof(u32));
+  if (bit_count == 0) {
+    return;
+  }
+  for (u32 i = 0; i < BLOCK_SIZE; ++i) {
+    u32 v = values[i] - reference;
+    u32 bit = (i / LANE_COUNT) * bit_count;
+    u32* word = words + (bit / 32) * LANE_COUNT + i % LANE_COUNT;
+    u32 shift = bit % 32;
+    word[0] |= v << shift;
+    if (shift + bit_count > 32) {
+      word[LANE_COUNT] |= v >> (32 - shift);
+    }
+  }
+}
+
+// Deltas are summed from first_value
+bool unpack_blocks(std::string_view input,
+                   bool is_delta,
+                   u32 first_value,
+                   u32* output,
+                   usize count) {
+  const integer_kernels& kernels = get_kernels();
+  u32 tail[BLOCK_SIZE];
+  u32 carry = first_value;
+  for (usize start = 0; start < count; start += BLOCK_SIZE) {
+    block_header header;
+    if (input.size() < sizeof(header)) {
+      return false;
+    }
+    memcpy(&header, input.data(), sizeof(header));
+    input.remove_prefix(sizeof(header));
+    usize packed_size = header.bit_count * PACKED_WORD_COUNT * sizeof(u32);
+    if (header.bit_count > 32 || input.size() < packed_size) {
+      return false;
+    }
+
+    // The last block is padded, it goes through tail
+    usize size = std::min(BLOCK_SIZE, count - start);
+    u32* target = size == BLOCK_SIZE ? output + start : tail;
+    kernels.unpack[header.bit_count](input.data(), header.reference, target);
+    if (is_delta) {
+      carry = kernels.prefix_sum(target, BLOCK_SIZE, carry);
+    }
+    if (target == tail) {
+      memcpy(output + start, tail, size * sizeof(u32));
+    }
+    input.remove_prefix(packed_size);
+  }
+  return input.empty();
+}
+}  // namespace
+
+void delta_encode(std::span<u32> values) { delta_encode_all(values); }
+
+void delta_encode(std::span<u64> values) { delta_encode_all(values); }
+
+void delta_decode(std::span<u32> values) {
+  get_kernels().prefix_sum(values.data(), values.size(), 0);
+}
+
+void delta_decode(std::span<u64> values) {
+  u64 sum = 0;
+  for (u64& value : values) {
+    sum += value;
+    value = sum;
+  }
+}
+
+usize write_varint(u64 value, char* output) {
+  usize size = 0;
+  while (value >= 0x80) {
+    output[size++] = static_cast<char>(value | 0x80);
+    value >>= 7;
+  }
+  output[size++] = static_cast<char>(value);
+  return size;
+}
+
+beard::optional<u64> read_varint(std::string_view& input) {
+  auto p = reinterpret_cast<const u8*>(input.data());
+  u64 value = 0;
+  if (!read_one(p, p + input.size(), value)) {
+    return {};
+  }
+  input.remove_prefix(p - reinterpret_cast<const u8*>(input.data()));
+  return value;
+}
+
+void encode_varints(std::span<const u32> values, std::string& output) {
+  encode_all(values, output);
+}
+
+void encode_varints(std::span<const u64> values, std::string& output) {
+  encode_all(values, output);
+}
+
+bool decode_varints(std::string_view input, beard::array<u32>& values) {
+  return decode_all(input, values, get_kernels().decode32);
+}
+
+bool decode_varints(std::string_view input, beard::array<u64>& values) {
+  return decode_all(input, values, get_kernels().decode64);
+}
+
+void pack_integers(std::span<const u32> values,
+                   std::string& output,
+                   mode packing) {
+  char varint[MAX_VARINT_SIZE];
+  output.append(varint, write_varint(values.size(), varint));
+  output += static_cast<char>(packing);
+
+  // Deltas start from the first value, so that it does not widen a block
+  u32 previous = 0;
+  if (packing == mode::delta && !values.empty()) {
+    previous = values[0];
+    output.append(varint, write_varint(previous, varint));
+  }
+
+  u32 block[BLOCK_SIZE];
+  u32 words[BLOCK_SIZE];
+  for (usize start = 0; start < values.size(); start += BLOCK_SIZE) {
+    usize size = std::min(BLOCK_SIZE, values.size() - start);
+    for (usize i = 0; i < size; ++i) {
+      block[i] = values[start + i];
+      if (packing == mode::delta) {
+        block[i] -= previous;
+        previous = values[start + i];
+      }
+    }
+
+    auto [min, max] = std::minmax_element(block, block + size);
+    block_header header = {*min, static_cast<u32>(std::bit_width(*max - *min))};
+    // Padding with the reference keeps the bit count
+    std::fill(block + size, block + BLOCK_SIZE, header.reference);
+    pack_block(block, header.reference, header.bit_count, words);
+
+    output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.append(reinterpret_cast<const char*>(words),
+                  header.bit_count * PACKED_WORD_COUNT * sizeof(u32));
+  }
+}
+
+bool unpack_integers(std::string_view input, beard::array<u32>& values) {
+  auto count = read_varint(input);
+  if (!count.has_value() ||
+      count.value() > static_cast<u64>(std::numeric_limits<i32>::max()) ||
+      input.empty() ||
+      static_cast<u8>(input[0]) > static_cast<u8>(mode::delta)) {
+    values.clear();
+    return false;
+  }
+  bool is_delta = static_cast<mode>(static_cast<u8>(input[0])) == mode::delta;
+  input.remove_prefix(1);
+  beard::optional<u64> first_value = u64{0};
+  if (is_delta && count.value() > 0) {
+    first_value = read_varint(input);
+    if (!first_value.has_value() ||
+        first_value.value() > std::numeric_limits<u32>::max()) {
+      values.clear();
+      return false;
+    }
+  }
+
+  // Blocks take at least their header, which bounds the allocation
+  usize block_count = (count.value() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  if (block_count > input.size() / sizeof(block_header)) {
+    values.clear();
+    return false;
+  }
+
+  // Every value is overwritten, only growing the array clears memory
+  values.resize(static_cast<i32>(count.value()));
+  if (!unpack_blocks(input, is_delta, static_cast<u32>(first_value.value()),
+                     values.data(), count.value())) {
+    values.clear();
+    return false;
+  }
+  return true;
+}
+}  // namespace beard::io
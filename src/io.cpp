@@ -1,10 +1,21 @@
 #include "beard/io/io.h"
 
-#include <codecvt>
+#include <cerrno>
 #include <cstdio>
 #include <filesystem>
 
 #include "beard/core/macros.h"
+#include "beard/fmt/utf8.h"
+
+#if BEARD_PLATFORM_WINDOWS
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace beard::io {
 i64 file_write_time(std::string_view filename) {
@@ -14,7 +25,8 @@ i64 file_write_time(std::string_view filename) {
 }
 
 std::string read_whole_file(std::string_view filename) {
-  FILE* file = fopen(filename.data(), "rb");
+  std::string path{filename};
+  FILE* file = fopen(path.c_str(), "rb");
   if (file == nullptr) {
     return "";
   }
@@ -35,6 +47,85 @@ std::string read_whole_file(std::string_view filename) {
   return result;
 }
 
+bool write_whole_file(std::string_view filename, std::string_view content) {
+  std::string path{filename};
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  defer(fclose(file));
+
+  auto write_len = fwrite(content.data(), sizeof(char), content.size(), file);
+  return write_len == content.size();
+}
+
+bool write_whole_file_atomic(std::string_view filename,
+                             std::string_view content) {
+  std::string path{filename};
+
+#if BEARD_PLATFORM_WINDOWS
+  std::string temporary_path = path + ".tmp";
+  FILE* file = fopen(temporary_path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  bool is_written =
+      fwrite(content.data(), sizeof(char), content.size(), file) ==
+          content.size() &&
+      fflush(file) == 0 && _commit(_fileno(file)) == 0;
+  is_written &= fclose(file) == 0;
+
+  if (!is_written ||
+      !MoveFileExA(temporary_path.c_str(), path.c_str(),
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    remove(temporary_path.c_str());
+    return false;
+  }
+  return true;
+#else
+  std::string temporary_path = path + ".XXXXXX";
+  int fd = mkstemp(temporary_path.data());
+  if (fd < 0) {
+    return false;
+  }
+
+  // mkstemp creates files only readable by their owner, keep the permissions
+  // of the file being replaced instead
+  struct stat st;
+  fchmod(fd, ::stat(path.c_str(), &st) == 0 ? st.st_mode & 07777 : 0644);
+
+  bool is_written = true;
+  std::string_view remaining = content;
+  while (is_written && !remaining.empty()) {
+    ssize_t written = ::write(fd, remaining.data(), remaining.size());
+    if (written < 0) {
+      is_written = errno == EINTR;
+    } else {
+      remaining.remove_prefix(static_cast<usize>(written));
+    }
+  }
+  is_written = is_written && fsync(fd) == 0;
+  is_written &= ::close(fd) == 0;
+
+  if (!is_written || rename(temporary_path.c_str(), path.c_str()) != 0) {
+    unlink(temporary_path.c_str());
+    return false;
+  }
+
+  // The rename itself is only durable once the directory is synced
+  std::string directory = std::filesystem::path{path}.parent_path().string();
+  int directory_fd = ::open(directory.empty() ? "." : directory.c_str(),
+                            O_RDONLY | O_DIRECTORY);
+  if (directory_fd >= 0) {
+    fsync(directory_fd);
+    ::close(directory_fd);
+  }
+  return true;
+#endif
+}
+
 beard::optional<std::string> read_whole_file_if_newer(std::string_view filename,
                                                       i64 last_write,
                                                       i64* new_last_write) {
@@ -50,17 +141,150 @@ beard::optional<std::string> read_whole_file_if_newer(std::string_view filename,
   return result;
 }
 
-// std::u32string to_utf8(const std::string& str) {
-//   std::wstring_convert<std::codecvt_utf8<i32>, i32> converter;
-//
-//   auto as_int = converter.from_bytes(str);
-//   return {reinterpret_cast<char32_t const*>(as_int.data()), as_int.length()};
-// }
-//
-// std::string from_utf8(const std::u32string& str) {
-//   std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
-//
-//   auto as_char = converter.to_bytes(str);
-//   return {reinterpret_cast<char const*>(as_char.data(), as_char.length())};
-// }
+mapped_file::~mapped_file() { close(); }
+
+mapped_file::mapped_file(mapped_file&& other) noexcept {
+  *this = std::move(other);
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+  if (this != &other) {
+    close();
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_is_open = other.m_is_open;
+#if BEARD_PLATFORM_WINDOWS
+    m_file = other.m_file;
+    m_mapping = other.m_mapping;
+    other.m_file = nullptr;
+    other.m_mapping = nullptr;
+#endif
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_is_open = false;
+  }
+  return *this;
+}
+
+bool mapped_file::open(std::string_view filename) {
+  close();
+  std::string path{filename};
+
+#if BEARD_PLATFORM_WINDOWS
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+
+  m_file = file;
+  m_size = static_cast<usize>(size.QuadPart);
+  m_is_open = true;
+
+  // Mapping an empty file is an error on windows, just keep an empty view
+  if (m_size == 0) {
+    return true;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    close();
+    return false;
+  }
+  m_mapping = mapping;
+
+  m_data = static_cast<const char*>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (m_data == nullptr) {
+    close();
+    return false;
+  }
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  defer(::close(fd));
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return false;
+  }
+
+  m_size = static_cast<usize>(st.st_size);
+  m_is_open = true;
+
+  // mmap does not accept empty ranges, just keep an empty view
+  if (m_size == 0) {
+    return true;
+  }
+
+  void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    m_size = 0;
+    m_is_open = false;
+    return false;
+  }
+  m_data = static_cast<const char*>(data);
+#endif
+
+  return true;
+}
+
+void mapped_file::close() {
+#if BEARD_PLATFORM_WINDOWS
+  if (m_data != nullptr) {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping != nullptr) {
+    CloseHandle(m_mapping);
+  }
+  if (m_file != nullptr) {
+    CloseHandle(m_file);
+  }
+  m_file = nullptr;
+  m_mapping = nullptr;
+#else
+  if (m_data != nullptr) {
+    munmap(const_cast<char*>(m_data), m_size);
+  }
+#endif
+
+  m_data = nullptr;
+  m_size = 0;
+  m_is_open = false;
+}
+
+beard::optional<std::u32string> from_utf8(std::string_view text) {
+  std::u32string result;
+  result.resize(fmt::utf32_length_from_utf8(text));
+
+  auto conversion = fmt::utf8_to_utf32(text, result.data());
+  if (!conversion.ok()) {
+    return {};
+  }
+
+  return result;
+}
+
+beard::optional<std::string> to_utf8(std::u32string_view text) {
+  std::string result;
+  result.resize(fmt::utf8_length_from_utf32(text));
+
+  auto conversion = fmt::utf32_to_utf8(text, result.data());
+  if (!conversion.ok()) {
+    return {};
+  }
+
+  return result;
+}
 }  // namespace beard::io
\ No newline at end of file
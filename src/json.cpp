@@ -0,0 +1,614 @@
+#include "beard/fmt/json.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "beard/core/cpu.h"
+#include "beard/fmt/utf8.h"
+
+#if BEARD_HAS_SSE2
+#include <immintrin.h>
+#endif
+
+namespace beard::fmt {
+namespace {
+constexpr usize BLOCK_SIZE = 64;
+
+// One bit per byte of a 64 bytes block
+struct block_masks {
+  u64 whitespace;
+  u64 op;  // {}[]:,
+  u64 quote;
+  u64 backslash;
+};
+
+enum : u8 {
+  WHITESPACE = 1 << 0,
+  OP = 1 << 1,
+  QUOTE = 1 << 2,
+  BACKSLASH = 1 << 3,
+};
+
+constexpr auto CHARACTER_CLASSES = [] {
+  std::array<u8, 256> classes{};
+  for (u8 c : {' ', '\t', '\n', '\r'}) {
+    classes[c] = WHITESPACE;
+  }
+  for (u8 c : {'{', '}', '[', ']', ':', ','}) {
+    classes[c] = OP;
+  }
+  classes['"'] = QUOTE;
+  classes['\\'] = BACKSLASH;
+  return classes;
+}();
+
+block_masks classify_scalar(const char* block) {
+  block_masks masks{};
+  for (usize i = 0; i < BLOCK_SIZE; ++i) {
+    u8 c = CHARACTER_CLASSES[static_cast<u8>(block[i])];
+    masks.whitespace |= u64{(c & WHITESPACE) != 0} << i;
+    masks.op |= u64{(c & OP) != 0} << i;
+    masks.quote |= u64{(c & QUOTE) != 0} << i;
+    masks.backslash |= u64{(c & BACKSLASH) != 0} << i;
+  }
+  return masks;
+}
+
+#if BEARD_HAS_SSE2
+// Both tables are indexed by the low nibble of the byte, and only hold the
+// byte itself for the characters of the class. The entries of the other
+// nibbles never match any byte with that nibble. Bytes with the high bit set
+// look up 0, which matches nothing either.
+BEARD_TARGET("avx2")
+block_masks classify_avx2(const char* block) {
+  const __m256i whitespace_table =
+      _mm256_setr_epi8(' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n',
+                       112, 100, '\r', 100, 100, ' ', 100, 100, 100, 17, 100,
+                       113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100);
+  // '[' | 0x20 is '{' and ']' | 0x20 is '}', ',' and ':' have that bit set
+  const __m256i op_table = _mm256_setr_epi8(
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+
+  block_masks masks;
+  u32 whitespace[2];
+  u32 op[2];
+  u32 quote[2];
+  u32 backslash[2];
+  for (int half = 0; half < 2; ++half) {
+    __m256i input = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(block + half * 32));
+    __m256i whitespace_match = _mm256_shuffle_epi8(whitespace_table, input);
+    whitespace[half] = static_cast<u32>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(whitespace_match, input)));
+    op[half] = static_cast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+        _mm256_shuffle_epi8(op_table, input),
+        _mm256_or_si256(input, _mm256_set1_epi8(0x20)))));
+    quote[half] = static_cast<u32>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(input, _mm256_set1_epi8('"'))));
+    backslash[half] = static_cast<u32>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\\'))));
+  }
+
+  masks.whitespace = whitespace[0] | (u64{whitespace[1]} << 32);
+  masks.op = op[0] | (u64{op[1]} << 32);
+  masks.quote = quote[0] | (u64{quote[1]} << 32);
+  masks.backslash = backslash[0] | (u64{backslash[1]} << 32);
+  return masks;
+}
+#endif
+
+// Bit i is the xor of the bits up to i: set inside of the quotes, opening
+// quote included
+u64 prefix_xor(u64 bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+// Turns the masks of the blocks into structural positions, carrying the
+// state (inside of a string, after a backslash, ...) from one block to the
+// next
+class structural_indexer {
+ public:
+  explicit structural_indexer(beard::array<u32>& output)
+      : m_output{output}, m_capacity{output.element_count()} {}
+
+  void add_block(const block_masks& masks, usize position) {
+    // A block adds at most BLOCK_SIZE positions, grow the array beforehand
+    // instead of checking each position
+    constexpr i32 BLOCK_POSITIONS = static_cast<i32>(BLOCK_SIZE) + 1;
+    if (static_cast<i64>(m_written) + BLOCK_POSITIONS > m_capacity) {
+      m_capacity = m_capacity * 2 + BLOCK_POSITIONS;
+      m_output.resize(m_capacity);
+    }
+
+    u64 bits = structurals(masks);
+    u32* output = m_output.data() + m_written;
+    u32 base = static_cast<u32>(position);
+    while (bits != 0) {
+      *output++ = base + static_cast<u32>(std::countr_zero(bits));
+      bits &= bits - 1;
+    }
+    m_written = static_cast<u32>(output - m_output.data());
+  }
+
+  // Add the sentinel, false if the text ends inside of a string
+  bool finish(usize size, u32* count) {
+    // Texts without any block, such as an empty one, never grew the array
+    if (static_cast<i64>(m_written) + 1 > m_capacity) {
+      m_capacity = static_cast<i32>(m_written) + 1;
+      m_output.resize(m_capacity);
+    }
+    m_output[m_written] = static_cast<u32>(size);
+    *count = m_written;
+    return m_previous_in_string == 0;
+  }
+
+ private:
+  // Characters escaped by a backslash: the ones after an odd number of them
+  u64 find_escaped(u64 backslash) {
+    constexpr u64 EVEN_BITS = 0x5555555555555555ull;
+
+    backslash &= ~m_previous_escaped;
+    u64 follows_escape = (backslash << 1) | m_previous_escaped;
+    u64 odd_sequence_starts = backslash & ~EVEN_BITS & ~follows_escape;
+
+    // Adding the starts to the runs of backslashes carries past the end of
+    // each run, the carry out of the block is an escape for the next one
+    u64 sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+    m_previous_escaped = sequences_starting_on_even_bits < backslash;
+    u64 invert_mask = sequences_starting_on_even_bits << 1;
+    return (EVEN_BITS ^ invert_mask) & follows_escape;
+  }
+
+  u64 structurals(const block_masks& masks) {
+    u64 quote = masks.quote & ~find_escaped(masks.backslash);
+    u64 in_string = prefix_xor(quote) ^ m_previous_in_string;
+    m_previous_in_string =
+        static_cast<u64>(static_cast<i64>(in_string) >> 63);
+
+    // Values other than strings start after an operator or a whitespace
+    u64 scalar = ~(masks.op | masks.whitespace);
+    u64 non_quote_scalar = scalar & ~quote;
+    u64 follows_scalar = (non_quote_scalar << 1) | m_previous_scalar;
+    m_previous_scalar = non_quote_scalar >> 63;
+    u64 scalar_start = scalar & ~follows_scalar;
+
+    // Inside of the strings and their closing quote
+    u64 string_tail = in_string ^ quote;
+    return (masks.op | scalar_start) & ~string_tail;
+  }
+
+  beard::array<u32>& m_output;
+  i32 m_capacity;
+  u32 m_written = 0;
+
+  u64 m_previous_escaped = 0;
+  u64 m_previous_in_string = 0;
+  u64 m_previous_scalar = 0;
+};
+
+// The end of the text padded with whitespace to a whole block
+void copy_last_block(std::string_view text, usize position, char* block) {
+  memset(block, ' ', BLOCK_SIZE);
+  memcpy(block, text.data() + position, text.size() - position);
+}
+
+// The loops are written once per instruction set so that the classification
+// gets inlined
+bool index_structurals_scalar(std::string_view text,
+                              beard::array<u32>& output,
+                              u32* count) {
+  structural_indexer indexer{output};
+
+  usize i = 0;
+  for (; i + BLOCK_SIZE <= text.size(); i += BLOCK_SIZE) {
+    indexer.add_block(classify_scalar(text.data() + i), i);
+  }
+  if (i < text.size()) {
+    char last_block[BLOCK_SIZE];
+    copy_last_block(text, i, last_block);
+    indexer.add_block(classify_scalar(last_block), i);
+  }
+  return indexer.finish(text.size(), count);
+}
+
+#if BEARD_HAS_SSE2
+BEARD_TARGET("avx2")
+bool index_structurals_avx2(std::string_view text,
+                            beard::array<u32>& output,
+                            u32* count) {
+  structural_indexer indexer{output};
+
+  usize i = 0;
+  for (; i + BLOCK_SIZE <= text.size(); i += BLOCK_SIZE) {
+    indexer.add_block(classify_avx2(text.data() + i), i);
+  }
+  if (i < text.size()) {
+    char last_block[BLOCK_SIZE];
+    copy_last_block(text, i, last_block);
+    indexer.add_block(classify_avx2(last_block), i);
+  }
+  return indexer.finish(text.size(), count);
+}
+#endif
+
+using index_fn = bool (*)(std::string_view, beard::array<u32>&, u32*);
+
+index_fn select_index() {
+#if BEARD_HAS_SSE2
+  if (get_cpu_features().avx2) {
+    return index_structurals_avx2;
+  }
+#endif
+  return index_structurals_scalar;
+}
+
+bool is_whitespace(char c) {
+  return (CHARACTER_CLASSES[static_cast<u8>(c)] & WHITESPACE) != 0;
+}
+
+std::string_view trim_right(std::string_view text) {
+  while (!text.empty() && is_whitespace(text.back())) {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+i32 hex_digit(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool parse_hex4(std::string_view text, usize position, u32* value) {
+  if (position + 4 > text.size()) {
+    return false;
+  }
+  u32 result = 0;
+  for (usize i = 0; i < 4; ++i) {
+    i32 digit = hex_digit(text[position + i]);
+    if (digit < 0) {
+      return false;
+    }
+    result = (result << 4) | static_cast<u32>(digit);
+  }
+  *value = result;
+  return true;
+}
+
+// Decode the escape sequences of the contents of a string into output
+bool unescape(std::string_view text, std::string& output) {
+  output.clear();
+  output.reserve(text.size());
+
+  usize i = 0;
+  while (i < text.size()) {
+    usize backslash = text.find('\\', i);
+    if (backslash == std::string_view::npos) {
+      output.append(text.substr(i));
+      break;
+    }
+    output.append(text.substr(i, backslash - i));
+
+    if (backslash + 1 >= text.size()) {
+      return false;
+    }
+    char escaped = text[backslash + 1];
+    i = backslash + 2;
+    switch (escaped) {
+      case '"':
+      case '\\':
+      case '/':
+        output.push_back(escaped);
+        break;
+      case 'b':
+        output.push_back('\b');
+        break;
+      case 'f':
+        output.push_back('\f');
+        break;
+      case 'n':
+        output.push_back('\n');
+        break;
+      case 'r':
+        output.push_back('\r');
+        break;
+      case 't':
+        output.push_back('\t');
+        break;
+      case 'u': {
+        u32 code_point;
+        if (!parse_hex4(text, i, &code_point)) {
+          return false;
+        }
+        i += 4;
+
+        // Code points above the BMP are escaped as surrogate pairs
+        if (code_point >= 0xd800 && code_point <= 0xdbff) {
+          u32 low;
+          if (i + 2 > text.size() || text[i] != '\\' || text[i + 1] != 'u' ||
+              !parse_hex4(text, i + 2, &low) || low < 0xdc00 ||
+              low > 0xdfff) {
+            return false;
+          }
+          i += 6;
+          code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+        } else if (code_point >= 0xdc00 && code_point <= 0xdfff) {
+          return false;
+        }
+
+        char encoded[4];
+        char32_t c = code_point;
+        auto result = utf32_to_utf8({&c, 1}, encoded);
+        output.append(encoded, result.written_count);
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool json_document::parse(std::string_view text) {
+  ASSERT(text.size() < ~u32{0}, "json texts must be smaller than 4GB");
+
+  local_variable const auto index = select_index();
+
+  m_text = text;
+  return index(text, m_structurals, &m_structural_count);
+}
+
+json_value json_document::root() const {
+  if (m_structural_count == 0) {
+    return {};
+  }
+  return {this, 0};
+}
+
+json_array_range json_document::values() const {
+  if (m_structural_count == 0) {
+    return {};
+  }
+  return json_array_range{{this, 0, true}};
+}
+
+u32 json_document::skip_value(u32 index) const {
+  char c = char_at(index);
+  if (c != '{' && c != '[') {
+    return index + 1;
+  }
+
+  // Only the brackets matter, the other structurals are skipped over
+  i32 depth = 0;
+  for (; index < m_structural_count; ++index) {
+    switch (char_at(index)) {
+      case '{':
+      case '[':
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        if (--depth == 0) {
+          return index + 1;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return m_structural_count;
+}
+
+std::string_view json_document::key_at(u32 index) const {
+  // Keys are followed by their colon, check_field made sure of it
+  u32 start = m_structurals[index] + 1;
+  u32 end = m_structurals[index + 1];
+  std::string_view key = trim_right(m_text.substr(start, end - start));
+  if (key.empty() || key.back() != '"') {
+    return {};
+  }
+  key.remove_suffix(1);
+  return key;
+}
+
+char json_value::first_char() const {
+  return m_document == nullptr ? '\0' : m_document->char_at(m_index);
+}
+
+json_type json_value::type() const {
+  switch (first_char()) {
+    case '{':
+      return json_type::object;
+    case '[':
+      return json_type::array;
+    case '"':
+      return json_type::string;
+    case 't':
+    case 'f':
+      return json_type::boolean;
+    case 'n':
+      return json_type::null;
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      return json_type::number;
+    default:
+      return json_type::invalid;
+  }
+}
+
+std::string_view json_value::raw() const {
+  if (first_char() == '\0') {
+    return {};
+  }
+
+  const auto& structurals = m_document->m_structurals;
+  u32 start = structurals[m_index];
+  u32 end = structurals[m_document->skip_value(m_index)];
+  return trim_right(m_document->m_text.substr(start, end - start));
+}
+
+beard::optional<bool> json_value::get_bool() const {
+  std::string_view text = raw();
+  if (text == "true") {
+    return true;
+  }
+  if (text == "false") {
+    return false;
+  }
+  return {};
+}
+
+beard::optional<std::string_view> json_value::get_raw_string() const {
+  if (type() != json_type::string) {
+    return {};
+  }
+
+  // The closing quote is the last character before the next structural
+  std::string_view text = raw();
+  if (text.size() < 2 || text.back() != '"') {
+    return {};
+  }
+  return text.substr(1, text.size() - 2);
+}
+
+bool json_value::get_string(std::string& output) const {
+  auto text = get_raw_string();
+  if (!text.has_value()) {
+    return false;
+  }
+  return unescape(text.value(), output);
+}
+
+json_value json_value::operator[](std::string_view key) const {
+  for (json_field field : fields()) {
+    if (field.key == key) {
+      return field.value;
+    }
+  }
+  return {};
+}
+
+json_value json_value::at(i32 index) const {
+  for (json_value element : elements()) {
+    if (index-- == 0) {
+      return element;
+    }
+  }
+  return {};
+}
+
+json_array_range json_value::elements() const {
+  if (first_char() != '[' || m_document->char_at(m_index + 1) == ']') {
+    return {};
+  }
+  return json_array_range{{m_document, m_index + 1}};
+}
+
+json_object_range json_value::fields() const {
+  if (first_char() != '{') {
+    return {};
+  }
+  return json_object_range{{m_document, m_index + 1}};
+}
+
+json_array_iterator& json_array_iterator::operator++() {
+  u32 next = m_document->skip_value(m_index);
+  if (m_is_top_level) {
+    m_index = next < m_document->m_structural_count ? next : END;
+  } else if (m_document->char_at(next) == ',') {
+    m_index = next + 1;
+  } else {
+    m_index = END;
+  }
+  return *this;
+}
+
+json_object_iterator::json_object_iterator(const json_document* document,
+                                           u32 index)
+    : m_document{document}, m_index{index} {
+  check_field();
+}
+
+void json_object_iterator::check_field() {
+  // A field is a string, a colon and a value
+  if (m_document->char_at(m_index) != '"' ||
+      m_document->char_at(m_index + 1) != ':') {
+    m_index = json_array_iterator::END;
+  }
+}
+
+json_field json_object_iterator::operator*() const {
+  return {m_document->key_at(m_index), json_value{m_document, m_index + 2}};
+}
+
+json_object_iterator& json_object_iterator::operator++() {
+  u32 next = m_document->skip_value(m_index + 2);
+  if (m_document->char_at(next) == ',') {
+    m_index = next + 1;
+    check_field();
+  } else {
+    m_index = json_array_iterator::END;
+  }
+  return *this;
+}
+
+bool ndjson_reader::next(json_value& value) {
+  if (m_current != json_array_iterator{}) {
+    value = *m_current;
+    ++m_current;
+    return true;
+  }
+
+  while (m_position < m_text.size() && !m_has_error) {
+    // Whole lines, at least one even if it is longer than a batch
+    usize end = m_text.size();
+    if (m_position + m_batch_size < m_text.size()) {
+      end = m_text.rfind('\n', m_position + m_batch_size);
+      if (end == std::string_view::npos || end <= m_position) {
+        end = m_text.find('\n', m_position + m_batch_size);
+        end = end == std::string_view::npos ? m_text.size() : end;
+      }
+    }
+
+    std::string_view batch = m_text.substr(m_position, end - m_position);
+    m_position = end;
+    if (!m_document.parse(batch)) {
+      m_has_error = true;
+      return false;
+    }
+
+    m_current = m_document.values().begin();
+    if (m_current != json_array_iterator{}) {
+      value = *m_current;
+      ++m_current;
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace beard::fmt
@@ -0,0 +1,276 @@
+#include "beard/io/pack.h"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "beard/io/buffered_file_writer.h"
+#include "beard/misc/hash.h"
+
+namespace beard::io {
+namespace {
+using namespace pack_detail;
+
+u64 align_up(u64 value, u64 alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+u64 path_hash(std::string_view path) {
+  u64 hash = hash64::hash(path);
+  return hash != 0 ? hash : 1;
+}
+
+bool pad(buffered_file_writer& writer, u64 alignment) {
+  static constexpr char ZEROES[SECTION_ALIGNMENT > BLOB_ALIGNMENT
+                                   ? SECTION_ALIGNMENT
+                                   : BLOB_ALIGNMENT] = {};
+  u64 size = writer.size();
+  return writer.write({ZEROES, align_up(size, alignment) - size});
+}
+}  // namespace
+
+void pack_builder::add(std::string_view path, std::string_view content) {
+  entry& e = entry_for(path);
+  e.content = content;
+  e.filename.clear();
+  e.is_file = false;
+}
+
+void pack_builder::add_file(std::string_view path, std::string_view filename) {
+  entry& e = entry_for(path);
+  e.content.clear();
+  e.filename = filename;
+  e.is_file = true;
+}
+
+pack_builder::entry& pack_builder::entry_for(std::string_view path) {
+  std::string key{path};
+  if (auto found = m_indices.find(key); found != m_indices.end()) {
+    return m_entries[found->second];
+  }
+  m_indices.add(key, m_entries.element_count());
+  m_entries.add(entry{std::move(key)});
+  return m_entries.last();
+}
+
+bool pack_builder::write(std::string_view filename) const {
+  buffered_file_writer writer;
+  if (!writer.open(filename)) {
+    return false;
+  }
+
+  // Keep the load factor under 75% so that probing always ends on a hole
+  u64 entry_count = static_cast<u64>(m_entries.element_count());
+  u64 slot_count = 8;
+  while (slot_count * 3 < entry_count * 4) {
+    slot_count *= 2;
+  }
+
+  std::vector<slot> slots(slot_count);
+  memset(slots.data(), 0, slots.size() * sizeof(slot));
+  std::string strings;
+
+  bool is_valid = true;
+  for (const entry& e : m_entries) {
+    mapped_file file;
+    std::string_view content = e.content;
+    if (e.is_file) {
+      if (!file.open(e.filename)) {
+        is_valid = false;
+        break;
+      }
+      content = file.view();
+    }
+
+    if (!pad(writer, BLOB_ALIGNMENT)) {
+      is_valid = false;
+      break;
+    }
+
+    slot s;
+    memset(&s, 0, sizeof(s));
+    s.hash = path_hash(e.path);
+    s.path_offset = strings.size();
+    s.path_length = static_cast<u32>(e.path.size());
+    s.crc = crc32::hash(content);
+    s.data_offset = writer.size();
+    s.data_size = content.size();
+    strings.append(e.path);
+
+    if (!writer.write(content)) {
+      is_valid = false;
+      break;
+    }
+
+    u64 index = s.hash & (slot_count - 1);
+    while (slots[index].hash != 0) {
+      index = (index + 1) & (slot_count - 1);
+    }
+    slots[index] = s;
+  }
+
+  footer f;
+  memset(&f, 0, sizeof(f));
+  f.magic = MAGIC;
+  f.version = VERSION;
+  f.slot_size = sizeof(slot);
+  f.entry_count = entry_count;
+  f.slot_count = slot_count;
+
+  if (is_valid) {
+    is_valid = pad(writer, SECTION_ALIGNMENT);
+    f.slots_offset = writer.size();
+    is_valid = is_valid &&
+               writer.write({reinterpret_cast<const char*>(slots.data()),
+                             slots.size() * sizeof(slot)});
+    f.strings_offset = writer.size();
+    f.strings_size = strings.size();
+    is_valid = is_valid && writer.write(strings);
+    f.total_size = writer.size() + sizeof(f);
+    is_valid = is_valid &&
+               writer.write({reinterpret_cast<const char*>(&f), sizeof(f)});
+  }
+
+  if (!writer.close() || !is_valid) {
+    std::string path{filename};
+    std::remove(path.c_str());
+    return false;
+  }
+  return true;
+}
+
+pack_file::pack_file(pack_file&& other) noexcept {
+  *this = std::move(other);
+}
+
+pack_file& pack_file::operator=(pack_file&& other) noexcept {
+  if (this != &other) {
+    // The mapping keeps its address when m_file moves, only the source must
+    // stop pointing into it
+    m_file = std::move(other.m_file);
+    m_slots = other.m_slots;
+    m_strings = other.m_strings;
+    m_slot_count = other.m_slot_count;
+    m_entry_count = other.m_entry_count;
+    other.m_slots = nullptr;
+    other.m_strings = nullptr;
+    other.m_slot_count = 0;
+    other.m_entry_count = 0;
+  }
+  return *this;
+}
+
+bool pack_file::open(std::string_view filename) {
+  close();
+  if (!m_file.open(filename)) {
+    return false;
+  }
+  if (!attach()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void pack_file::close() {
+  m_file.close();
+  m_slots = nullptr;
+  m_strings = nullptr;
+  m_slot_count = 0;
+  m_entry_count = 0;
+}
+
+beard::optional<std::string_view> pack_file::find(
+    std::string_view path) const {
+  u64 index = find_index(path);
+  if (index == m_slot_count) {
+    return {};
+  }
+  return content_of(m_slots[index]);
+}
+
+bool pack_file::verify() const {
+  for (u64 i = 0; i < m_slot_count; ++i) {
+    if (m_slots[i].hash != 0 &&
+        crc32::hash(content_of(m_slots[i])) != m_slots[i].crc) {
+      return false;
+    }
+  }
+  return true;
+}
+
+u64 pack_file::find_index(std::string_view path) const {
+  if (m_slot_count == 0) {
+    return 0;
+  }
+
+  u64 hash = path_hash(path);
+  u64 index = hash & (m_slot_count - 1);
+  for (;;) {
+    const slot& s = m_slots[index];
+    if (s.hash == 0) {
+      return m_slot_count;
+    }
+    if (s.hash == hash && path_of(s) == path) {
+      return index;
+    }
+    index = (index + 1) & (m_slot_count - 1);
+  }
+}
+
+bool pack_file::attach() {
+  std::string_view bytes = m_file.view();
+  if (bytes.size() < sizeof(footer)) {
+    return false;
+  }
+
+  footer f;
+  memcpy(&f, bytes.data() + bytes.size() - sizeof(f), sizeof(f));
+
+  bool valid = f.magic == MAGIC && f.version == VERSION &&
+               f.slot_size == sizeof(slot) && f.total_size == bytes.size() &&
+               f.slot_count != 0 && (f.slot_count & (f.slot_count - 1)) == 0 &&
+               f.slot_count <= f.total_size / sizeof(slot) &&
+               f.entry_count < f.slot_count &&
+               f.slots_offset <= f.total_size &&
+               f.slot_count * sizeof(slot) <= f.total_size - f.slots_offset &&
+               f.strings_offset <= f.total_size &&
+               f.strings_size <= f.total_size - f.strings_offset;
+  if (!valid) {
+    return false;
+  }
+
+  auto slots = bytes.data() + f.slots_offset;
+  if (reinterpret_cast<usize>(slots) % alignof(slot) != 0) {
+    return false;
+  }
+
+  // Check every entry once here, so that lookups do not have to
+  m_slots = reinterpret_cast<const slot*>(slots);
+  u64 entry_count = 0;
+  for (u64 i = 0; i < f.slot_count; ++i) {
+    const slot& s = m_slots[i];
+    if (s.hash == 0) {
+      continue;
+    }
+    ++entry_count;
+    if (s.path_offset > f.strings_size ||
+        s.path_length > f.strings_size - s.path_offset ||
+        s.data_size > f.slots_offset ||
+        s.data_offset > f.slots_offset - s.data_size) {
+      m_slots = nullptr;
+      return false;
+    }
+  }
+  if (entry_count != f.entry_count) {
+    m_slots = nullptr;
+    return false;
+  }
+
+  m_strings = bytes.data() + f.strings_offset;
+  m_slot_count = f.slot_count;
+  m_entry_count = f.entry_count;
+  return true;
+}
+}  // namespace beard::io
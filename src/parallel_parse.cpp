@@ -0,0 +1,79 @@
+#include "beard/fmt/parallel_parse.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace beard::fmt {
+namespace {
+// Position right after the end of the record going on at from, knowing
+// whether from is between quotes
+usize find_record_end(std::string_view text,
+                      usize from,
+                      char quote,
+                      bool in_quotes) {
+  if (quote == '\0') {
+    auto p = static_cast<const char*>(
+        memchr(text.data() + from, '\n', text.size() - from));
+    return p != nullptr ? p - text.data() + 1 : text.size();
+  }
+
+  for (usize i = from; i < text.size(); ++i) {
+    if (text[i] == quote) {
+      in_quotes = !in_quotes;
+    } else if (text[i] == '\n' && !in_quotes) {
+      return i + 1;
+    }
+  }
+  return text.size();
+}
+}  // namespace
+
+beard::array<std::string_view> split_records(std::string_view text,
+                                             i32 chunk_count,
+                                             char quote,
+                                             thread_pool& pool) {
+  beard::array<std::string_view> chunks;
+  if (text.empty()) {
+    return chunks;
+  }
+
+  chunk_count = std::max(chunk_count, 1);
+  beard::array<usize> boundaries;
+  boundaries.reserve(chunk_count + 1);
+  for (i32 i = 0; i <= chunk_count; ++i) {
+    boundaries.add(text.size() / chunk_count * i +
+                   text.size() % chunk_count * i / chunk_count);
+  }
+
+  // Whether a boundary is between quotes only depends on the parity of the
+  // number of quotes before it. Counting them is as parallel as the rest.
+  beard::array<u8> in_quotes(chunk_count + 1, 0);
+  if (quote != '\0') {
+    pool.parallel_for(chunk_count, [&](i32 i) {
+      auto begin = text.begin() + boundaries[i];
+      auto end = text.begin() + boundaries[i + 1];
+      in_quotes[i + 1] = std::count(begin, end, quote) & 1;
+    });
+    for (i32 i = 1; i <= chunk_count; ++i) {
+      in_quotes[i] ^= in_quotes[i - 1];
+    }
+  }
+
+  pool.parallel_for(chunk_count - 1, [&](i32 i) {
+    boundaries[i + 1] = find_record_end(text, boundaries[i + 1], quote,
+                                        in_quotes[i + 1] != 0);
+  });
+
+  // A record longer than a chunk swallows the next boundaries
+  usize start = 0;
+  for (i32 i = 1; i <= chunk_count; ++i) {
+    usize end = std::max(boundaries[i], start);
+    if (end > start) {
+      chunks.add(text.substr(start, end - start));
+      start = end;
+    }
+  }
+
+  return chunks;
+}
+}  // namespace beard::fmt
@@ -0,0 +1,127 @@
+#include "beard/io/serialization.h"
+
+#include <filesystem>
+
+namespace beard::io {
+using namespace serialization;
+
+bool binary_writer::open(std::string_view filename) {
+  close();
+  m_output = nullptr;
+  return m_file.open(filename);
+}
+
+bool binary_writer::close() {
+  if (!m_file.is_open()) {
+    return !has_error();
+  }
+  return m_file.close();
+}
+
+bool binary_writer::write_header(u32 version) {
+  return write(MAGIC) && write(FORMAT_VERSION) && write(version) &&
+         write(u32{0});
+}
+
+bool binary_reader::open(std::string_view filename) {
+  close();
+  m_data = nullptr;
+  m_end = nullptr;
+  m_version = 0;
+  m_has_error = false;
+
+  std::string path{filename};
+  std::error_code error;
+  u64 size = std::filesystem::file_size(path, error);
+  if (error) {
+    return false;
+  }
+  m_file = fopen(path.c_str(), "rb");
+  if (m_file == nullptr) {
+    return false;
+  }
+  // Small reads are buffered here, large ones should reach the file directly
+  setvbuf(m_file, nullptr, _IONBF, 0);
+
+  if (m_buffer == nullptr) {
+    m_buffer = std::make_unique_for_overwrite<char[]>(BUFFER_SIZE);
+  }
+  m_file_remaining = size;
+  return true;
+}
+
+void binary_reader::close() {
+  if (m_file != nullptr) {
+    fclose(m_file);
+    m_file = nullptr;
+  }
+  m_file_remaining = 0;
+}
+
+beard::optional<u32> binary_reader::read_header() {
+  header h;
+  if (!read(h.magic) || !read(h.format_version) || !read(h.version) ||
+      !read(h.reserved)) {
+    return {};
+  }
+  if (h.magic != MAGIC || h.format_version != FORMAT_VERSION) {
+    fail();
+    return {};
+  }
+  m_version = h.version;
+  return m_version;
+}
+
+bool binary_reader::read_count(usize& count, usize element_size) {
+  u64 stored_count = 0;
+  if (!read(stored_count)) {
+    return false;
+  }
+  if (stored_count > remaining() / element_size) {
+    return fail();
+  }
+  count = static_cast<usize>(stored_count);
+  return true;
+}
+
+bool binary_reader::fail() {
+  m_has_error = true;
+  m_data = m_end;
+  m_file_remaining = 0;
+  return false;
+}
+
+bool binary_reader::read_slow(void* data, usize size) {
+  if (m_has_error || size > remaining()) {
+    return fail();
+  }
+
+  auto out = static_cast<char*>(data);
+  usize buffered = m_end - m_data;
+  if (buffered > 0) {
+    memcpy(out, m_data, buffered);
+    out += buffered;
+    size -= buffered;
+    m_data = m_end;
+  }
+
+  // What does not fit in the buffer skips it
+  if (size >= BUFFER_SIZE) {
+    if (fread(out, 1, size, m_file) != size) {
+      return fail();
+    }
+    m_file_remaining -= size;
+    return true;
+  }
+
+  usize read_size = std::min<u64>(BUFFER_SIZE, m_file_remaining);
+  if (fread(m_buffer.get(), 1, read_size, m_file) != read_size) {
+    return fail();
+  }
+  m_file_remaining -= read_size;
+  memcpy(out, m_buffer.get(), size);
+  m_data = m_buffer.get() + size;
+  m_end = m_buffer.get() + read_size;
+  return true;
+}
+}  // namespace beard::io
@@ -0,0 +1,143 @@
+#include "beard/misc/string_interner.h"
+
+#include <bit>
+
+#include "beard/misc/hash.h"
+
+namespace beard {
+namespace {
+constexpr u64 INITIAL_TABLE_SIZE = 1024;
+
+struct segment_location {
+  u32 segment;
+  u32 offset;
+};
+
+segment_location locate(string_id id, u32 first_segment_bits) {
+  u64 index = u64{id} + (u64{1} << first_segment_bits);
+  u32 bit = static_cast<u32>(std::bit_width(index)) - 1;
+  return {bit - first_segment_bits,
+          static_cast<u32>(index - (u64{1} << bit))};
+}
+
+u64 make_slot(u64 hash, string_id id) {
+  return (hash & 0xffffffff00000000ull) | (u64{id} + 1);
+}
+}  // namespace
+
+string_interner::string_interner() {
+  auto t = std::make_unique<table>();
+  t->mask = INITIAL_TABLE_SIZE - 1;
+  t->slots.reset(new std::atomic<u64>[INITIAL_TABLE_SIZE]());
+  m_table.store(t.get(), std::memory_order_release);
+  m_tables.add(std::move(t));
+}
+
+string_interner::~string_interner() {
+  for (auto& segment : m_segments) {
+    delete[] segment.load(std::memory_order_relaxed);
+  }
+}
+
+string_id string_interner::intern(std::string_view string) {
+  u64 hash = hash64::hash(string);
+  if (auto id = find(string, hash); id.has_value()) {
+    return id.value();
+  }
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+
+  // Someone may have added it while we were waiting for the lock
+  if (auto id = find(string, hash); id.has_value()) {
+    return id.value();
+  }
+
+  string_id id = m_count.load(std::memory_order_relaxed);
+  auto [segment_index, offset] = locate(id, FIRST_SEGMENT_BITS);
+
+  entry* segment = m_segments[segment_index].load(std::memory_order_relaxed);
+  if (segment == nullptr) {
+    segment = new entry[usize{1} << (segment_index + FIRST_SEGMENT_BITS)];
+    m_segments[segment_index].store(segment, std::memory_order_release);
+  }
+
+  auto stored = m_arena.copy_string(string);
+  segment[offset] = {stored.data(), static_cast<u32>(stored.size()), hash};
+
+  table* t = m_table.load(std::memory_order_relaxed);
+  if ((u64{id} + 1) * 2 > t->mask + 1) {
+    grow();
+    t = m_table.load(std::memory_order_relaxed);
+  }
+
+  // The release store on the slot publishes the entry to lock free readers
+  insert_slot(t, hash, id);
+  m_count.store(id + 1, std::memory_order_release);
+
+  return id;
+}
+
+beard::optional<string_id> string_interner::find(
+    std::string_view string) const {
+  return find(string, hash64::hash(string));
+}
+
+std::string_view string_interner::get(string_id id) const {
+  ASSERT(id < m_count.load(std::memory_order_acquire), "Invalid string id");
+  const entry* e = find_entry(id);
+  return {e->data, e->length};
+}
+
+const string_interner::entry* string_interner::find_entry(string_id id) const {
+  auto [segment_index, offset] = locate(id, FIRST_SEGMENT_BITS);
+  return m_segments[segment_index].load(std::memory_order_acquire) + offset;
+}
+
+beard::optional<string_id> string_interner::find(std::string_view string,
+                                                 u64 hash) const {
+  const table* t = m_table.load(std::memory_order_acquire);
+
+  u64 index = hash & t->mask;
+  for (;;) {
+    u64 slot = t->slots[index].load(std::memory_order_acquire);
+    if (slot == 0) {
+      return {};
+    }
+
+    if ((slot ^ hash) >> 32 == 0) {
+      string_id id = static_cast<string_id>(slot) - 1;
+      const entry* e = find_entry(id);
+      if (e->hash == hash && std::string_view{e->data, e->length} == string) {
+        return id;
+      }
+    }
+
+    index = (index + 1) & t->mask;
+  }
+}
+
+void string_interner::insert_slot(table* t, u64 hash, string_id id) {
+  u64 index = hash & t->mask;
+  while (t->slots[index].load(std::memory_order_relaxed) != 0) {
+    index = (index + 1) & t->mask;
+  }
+  t->slots[index].store(make_slot(hash, id), std::memory_order_release);
+}
+
+void string_interner::grow() {
+  const table* old_table = m_table.load(std::memory_order_relaxed);
+  u64 size = (old_table->mask + 1) * 2;
+
+  auto t = std::make_unique<table>();
+  t->mask = size - 1;
+  t->slots.reset(new std::atomic<u64>[size]());
+
+  string_id count = m_count.load(std::memory_order_relaxed);
+  for (string_id id = 0; id < count; ++id) {
+    insert_slot(t.get(), find_entry(id)->hash, id);
+  }
+
+  m_table.store(t.get(), std::memory_order_release);
+  m_tables.add(std::move(t));
+}
+}  // namespace beard
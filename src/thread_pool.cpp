@@ -0,0 +1,59 @@
+#include "beard/misc/thread_pool.h"
+
+namespace beard {
+thread_pool::thread_pool(i32 thread_count) {
+  if (thread_count <= 0) {
+    thread_count =
+        std::max(1, static_cast<i32>(std::thread::hardware_concurrency()));
+  }
+
+  m_threads.reserve(thread_count);
+  for (i32 i = 0; i < thread_count; ++i) {
+    m_threads.add(std::thread{[this] { run_worker(); }});
+  }
+}
+
+thread_pool::~thread_pool() {
+  {
+    std::lock_guard lock{m_mutex};
+    m_is_stopping = true;
+  }
+  m_has_tasks.notify_all();
+
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void thread_pool::submit(std::function<void()> task) {
+  {
+    std::lock_guard lock{m_mutex};
+    m_tasks.push_back(std::move(task));
+  }
+  m_has_tasks.notify_one();
+}
+
+thread_pool& thread_pool::shared() {
+  static thread_pool pool;
+  return pool;
+}
+
+void thread_pool::run_worker() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock{m_mutex};
+      m_has_tasks.wait(lock,
+                       [this] { return m_is_stopping || !m_tasks.empty(); });
+      // Remaining tasks are still run when stopping
+      if (m_tasks.empty()) {
+        return;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+
+    task();
+  }
+}
+}  // namespace beard
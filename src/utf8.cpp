@@ -0,0 +1,371 @@
+#include "beard/fmt/utf8.h"
+
+#include <cstring>
+
+#include "beard/core/cpu.h"
+
+#if BEARD_HAS_SSE2
+#include <immintrin.h>
+#endif
+
+namespace beard::fmt {
+namespace {
+constexpr u64 HIGH_BITS = 0x8080808080808080ull;
+
+bool is_ascii(const char* p) {
+  u64 v;
+  memcpy(&v, p, sizeof(v));
+  return (v & HIGH_BITS) == 0;
+}
+
+bool is_continuation(u8 byte) { return (byte & 0xc0) == 0x80; }
+
+// Decode the sequence starting at p into code_point and return its length,
+// or 0 if it is not valid
+usize decode(const u8* p, usize remaining, char32_t* code_point) {
+  u8 lead = p[0];
+  if (lead < 0x80) {
+    *code_point = lead;
+    return 1;
+  }
+
+  // Continuation bytes, and leads of overlong 2 bytes sequences
+  if (lead < 0xc2) {
+    return 0;
+  }
+
+  if (lead < 0xe0) {
+    if (remaining < 2 || !is_continuation(p[1])) {
+      return 0;
+    }
+    *code_point = (char32_t{lead & 0x1fu} << 6) | (p[1] & 0x3fu);
+    return 2;
+  }
+
+  if (lead < 0xf0) {
+    if (remaining < 3 || !is_continuation(p[1]) || !is_continuation(p[2])) {
+      return 0;
+    }
+    char32_t c = (char32_t{lead & 0x0fu} << 12) |
+                 (char32_t{p[1] & 0x3fu} << 6) | (p[2] & 0x3fu);
+    if (c < 0x800 || (c >= 0xd800 && c <= 0xdfff)) {
+      return 0;
+    }
+    *code_point = c;
+    return 3;
+  }
+
+  if (lead < 0xf5) {
+    if (remaining < 4 || !is_continuation(p[1]) || !is_continuation(p[2]) ||
+        !is_continuation(p[3])) {
+      return 0;
+    }
+    char32_t c = (char32_t{lead & 0x07u} << 18) |
+                 (char32_t{p[1] & 0x3fu} << 12) |
+                 (char32_t{p[2] & 0x3fu} << 6) | (p[3] & 0x3fu);
+    if (c < 0x10000 || c > 0x10ffff) {
+      return 0;
+    }
+    *code_point = c;
+    return 4;
+  }
+
+  return 0;
+}
+
+bool validate_scalar(const char* data, usize size) {
+  auto bytes = reinterpret_cast<const u8*>(data);
+  usize i = 0;
+  while (i < size) {
+    if (size - i >= 8 && is_ascii(data + i)) {
+      i += 8;
+      continue;
+    }
+
+    char32_t code_point;
+    usize length = decode(bytes + i, size - i, &code_point);
+    if (length == 0) {
+      return false;
+    }
+    i += length;
+  }
+  return true;
+}
+
+#if BEARD_HAS_SSE2
+// Lookup algorithm from "Validating UTF-8 In Less Than One Instruction Per
+// Byte" (Keiser, Lemire). Every error of a 2 bytes window shows up as a bit
+// set in the three tables indexed by the high nibble of the first byte, its
+// low nibble and the high nibble of the second byte. Whether continuation
+// bytes are expected 2 or 3 bytes after a lead byte is checked separately.
+constexpr u8 TOO_SHORT = 1 << 0;  // 11______ 0_______ or 11______ 11______
+constexpr u8 TOO_LONG = 1 << 1;   // 0_______ 10______
+constexpr u8 OVERLONG_3 = 1 << 2;  // 11100000 100_____
+constexpr u8 TOO_LARGE = 1 << 3;   // 11110100 1001____ and above
+constexpr u8 SURROGATE = 1 << 4;   // 11101101 101_____
+constexpr u8 OVERLONG_2 = 1 << 5;  // 1100000_ 10______
+constexpr u8 TOO_LARGE_1000 = 1 << 6;  // 11110101 1000____ and above
+constexpr u8 OVERLONG_4 = 1 << 6;      // 11110000 1000____
+constexpr u8 TWO_CONTINUATIONS = 1 << 7;  // 10______ 10______
+constexpr u8 CARRY = TOO_SHORT | TOO_LONG | TWO_CONTINUATIONS;
+
+constexpr u8 FIRST_HIGH_NIBBLE[16] = {
+    // 0_______ ASCII
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TOO_LONG,
+    // 10______ continuation
+    TWO_CONTINUATIONS, TWO_CONTINUATIONS, TWO_CONTINUATIONS,
+    TWO_CONTINUATIONS,
+    // 1100____ and 1101____ 2 bytes lead
+    TOO_SHORT | OVERLONG_2, TOO_SHORT,
+    // 1110____ 3 bytes lead
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    // 1111____ 4 bytes lead
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+
+constexpr u8 FIRST_LOW_NIBBLE[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,  // ____0000
+    CARRY | OVERLONG_2,                            // ____0001
+    CARRY,                                         // ____0010
+    CARRY,                                         // ____0011
+    CARRY | TOO_LARGE,                             // ____0100
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____0101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____0110
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____0111
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____1000
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____1001
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____1010
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____1011
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____1100
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,  // ____1101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,            // ____1110
+    CARRY | TOO_LARGE | TOO_LARGE_1000};           // ____1111
+
+constexpr u8 SECOND_HIGH_NIBBLE[16] = {
+    // 0_______ ASCII
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_SHORT, TOO_SHORT,
+    // 1000____
+    TOO_LONG | OVERLONG_2 | TWO_CONTINUATIONS | OVERLONG_3 | TOO_LARGE_1000 |
+        OVERLONG_4,
+    // 1001____
+    TOO_LONG | OVERLONG_2 | TWO_CONTINUATIONS | OVERLONG_3 | TOO_LARGE,
+    // 101_____
+    TOO_LONG | OVERLONG_2 | TWO_CONTINUATIONS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTINUATIONS | SURROGATE | TOO_LARGE,
+    // 11______
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+
+// The vectors are 2 lanes of 16 bytes, pshufb looks up in each lane
+BEARD_TARGET("avx2")
+__m256i load_table(const u8* table) {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+// Input shifted by N bytes, with the last bytes of the previous block first
+template <int N>
+BEARD_TARGET("avx2")
+__m256i previous_bytes(__m256i input, __m256i previous) {
+  return _mm256_alignr_epi8(
+      input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+struct utf8_checker {
+  __m256i first_high;
+  __m256i first_low;
+  __m256i second_high;
+  __m256i error;
+  __m256i previous;
+  __m256i previous_incomplete;
+
+  BEARD_TARGET("avx2")
+  utf8_checker()
+      : first_high{load_table(FIRST_HIGH_NIBBLE)},
+        first_low{load_table(FIRST_LOW_NIBBLE)},
+        second_high{load_table(SECOND_HIGH_NIBBLE)},
+        error{_mm256_setzero_si256()},
+        previous{_mm256_setzero_si256()},
+        previous_incomplete{_mm256_setzero_si256()} {}
+
+  BEARD_TARGET("avx2")
+  void check(__m256i input) {
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+    __m256i previous_1 = previous_bytes<1>(input, previous);
+    __m256i special_cases = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(
+                first_high,
+                _mm256_and_si256(_mm256_srli_epi16(previous_1, 4), nibble)),
+            _mm256_shuffle_epi8(first_low,
+                                _mm256_and_si256(previous_1, nibble))),
+        _mm256_shuffle_epi8(second_high,
+                            _mm256_and_si256(_mm256_srli_epi16(input, 4),
+                                             nibble)));
+
+    // Third and fourth bytes of 3 and 4 bytes sequences must be
+    // continuations. These are the only TWO_CONTINUATIONS that are fine.
+    __m256i third = _mm256_subs_epu8(previous_bytes<2>(input, previous),
+                                     _mm256_set1_epi8(0xe0 - 0x80));
+    __m256i fourth = _mm256_subs_epu8(previous_bytes<3>(input, previous),
+                                      _mm256_set1_epi8(0xf0 - 0x80));
+    __m256i must_be_continuation =
+        _mm256_and_si256(_mm256_or_si256(third, fourth),
+                         _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    error = _mm256_or_si256(
+        error, _mm256_xor_si256(must_be_continuation, special_cases));
+  }
+
+  // Whether the block ends in the middle of a sequence
+  BEARD_TARGET("avx2")
+  static __m256i is_incomplete(__m256i input) {
+    const __m256i max_value = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xf0 - 1),
+        static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1));
+    return _mm256_subs_epu8(input, max_value);
+  }
+
+  BEARD_TARGET("avx2")
+  void check_block(const char* block) {
+    __m256i first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    __m256i second =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+    if (_mm256_movemask_epi8(_mm256_or_si256(first, second)) == 0) {
+      // Only ascii, the previous block had better be complete
+      error = _mm256_or_si256(error, previous_incomplete);
+      previous_incomplete = _mm256_setzero_si256();
+    } else {
+      check(first);
+      previous = first;
+      check(second);
+      previous_incomplete = is_incomplete(second);
+    }
+    previous = second;
+  }
+};
+
+BEARD_TARGET("avx2")
+bool validate_avx2(const char* data, usize size) {
+  utf8_checker checker;
+
+  usize i = 0;
+  for (; i + 64 <= size; i += 64) {
+    checker.check_block(data + i);
+  }
+
+  // Padding the end with ascii catches sequences cut by the end of the text
+  char last_block[64];
+  memset(last_block, 0, sizeof(last_block));
+  // Empty texts can come with a null data
+  if (size > i) {
+    memcpy(last_block, data + i, size - i);
+  }
+  checker.check_block(last_block);
+  checker.error = _mm256_or_si256(checker.error, checker.previous_incomplete);
+
+  return _mm256_testz_si256(checker.error, checker.error);
+}
+#endif
+
+using validate_fn = bool (*)(const char*, usize);
+
+validate_fn select_validate() {
+#if BEARD_HAS_SSE2
+  if (get_cpu_features().avx2) {
+    return validate_avx2;
+  }
+#endif
+  return validate_scalar;
+}
+
+usize encoded_length(char32_t code_point) {
+  return code_point < 0x80      ? 1
+         : code_point < 0x800   ? 2
+         : code_point < 0x10000 ? 3
+                                : 4;
+}
+}  // namespace
+
+bool is_valid_utf8(std::string_view text) {
+  local_variable const auto validate = select_validate();
+  return validate(text.data(), text.size());
+}
+
+usize utf32_length_from_utf8(std::string_view text) {
+  // Every byte but continuation bytes starts a code point
+  usize count = 0;
+  for (char c : text) {
+    count += !is_continuation(static_cast<u8>(c));
+  }
+  return count;
+}
+
+usize utf8_length_from_utf32(std::u32string_view text) {
+  usize length = 0;
+  for (char32_t c : text) {
+    length += encoded_length(c);
+  }
+  return length;
+}
+
+utf_conversion_result utf8_to_utf32(std::string_view text, char32_t* output) {
+  auto bytes = reinterpret_cast<const u8*>(text.data());
+  char32_t* start = output;
+
+  usize i = 0;
+  while (i < text.size()) {
+    if (text.size() - i >= 8 && is_ascii(text.data() + i)) {
+      for (usize j = 0; j < 8; ++j) {
+        output[j] = bytes[i + j];
+      }
+      output += 8;
+      i += 8;
+      continue;
+    }
+
+    usize length = decode(bytes + i, text.size() - i, output);
+    if (length == 0) {
+      return {static_cast<usize>(output - start), i};
+    }
+    ++output;
+    i += length;
+  }
+
+  return {static_cast<usize>(output - start)};
+}
+
+utf_conversion_result utf32_to_utf8(std::u32string_view text, char* output) {
+  auto out = reinterpret_cast<u8*>(output);
+
+  for (usize i = 0; i < text.size(); ++i) {
+    char32_t c = text[i];
+    if (c < 0x80) {
+      *out++ = static_cast<u8>(c);
+    } else if (c < 0x800) {
+      *out++ = static_cast<u8>(0xc0 | (c >> 6));
+      *out++ = static_cast<u8>(0x80 | (c & 0x3f));
+    } else if (c < 0x10000) {
+      if (c >= 0xd800 && c <= 0xdfff) {
+        return {static_cast<usize>(out - reinterpret_cast<u8*>(output)), i};
+      }
+      *out++ = static_cast<u8>(0xe0 | (c >> 12));
+      *out++ = static_cast<u8>(0x80 | ((c >> 6) & 0x3f));
+      *out++ = static_cast<u8>(0x80 | (c & 0x3f));
+    } else if (c <= 0x10ffff) {
+      *out++ = static_cast<u8>(0xf0 | (c >> 18));
+      *out++ = static_cast<u8>(0x80 | ((c >> 12) & 0x3f));
+      *out++ = static_cast<u8>(0x80 | ((c >> 6) & 0x3f));
+      *out++ = static_cast<u8>(0x80 | (c & 0x3f));
+    } else {
+      return {static_cast<usize>(out - reinterpret_cast<u8*>(output)), i};
+    }
+  }
+
+  return {static_cast<usize>(out - reinterpret_cast<u8*>(output))};
+}
+}  // namespace beard::fmt
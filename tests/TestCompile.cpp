@@ -1,11 +1,44 @@
 #include <beard/containers/array.h>
+#include <beard/containers/bloom_filter.h>
+#include <beard/containers/cuckoo_filter.h>
+#include <beard/containers/frozen_hash_map.h>
 #include <beard/containers/hash_map.h>
 #include <beard/core/macros.h>
+#include <beard/fmt/csv.h>
 #include <beard/fmt/fmt.h>
+#include <beard/fmt/json.h>
+#include <beard/fmt/parallel_parse.h>
+#include <beard/fmt/string_builder.h>
+#include <beard/fmt/utf8.h>
+#include <beard/io/async_reader.h>
+#include <beard/io/buffered_file_writer.h>
+#include <beard/io/compressed_file.h>
+#include <beard/io/compression.h>
+#include <beard/io/directory_scanner.h>
+#include <beard/io/file_cache.h>
+#include <beard/io/file_stream_reader.h>
+#include <beard/io/integer_codec.h>
+#include <beard/io/io.h>
+#include <beard/io/pack.h>
+#include <beard/io/serialization.h>
 #include <beard/misc/hash.h>
+#include <beard/misc/hyperloglog.h>
+#include <beard/misc/string_interner.h>
+#include <beard/misc/thread_pool.h>
 #include <beard/misc/timer.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <string>
+#include <thread>
 
 int main() {
   beard::hash_map<i32, real> a;
@@ -20,11 +53,612 @@ int main() {
   assert(v.value() == 12039813251203981);
   assert(*v == 12039813251203981);
 
+  beard::array<i64> numbers;
+  auto numbers_result = beard::fmt::parse_numbers<i64>(
+      "1 -22 123456789012345 9223372036854775807\n 42 4x2", numbers);
+  assert(numbers_result.parsed_count == 5 && numbers.last() == 42);
+  assert(numbers_result.error_position == 47);
+
+  assert(beard::fmt::parse_number<f64>("0.1").value() == 0.1);
+  assert(beard::fmt::parse_number<f64>("-1.5e-300").value() == -1.5e-300);
+  assert(beard::fmt::parse_number<f32>("3.4028235e38").value() ==
+         3.4028235e38f);
+  assert(!beard::fmt::parse_number<f64>("1e400").has_value());
+  char number_buffer[beard::fmt::FORMAT_NUMBER_BUFFER_SIZE];
+  auto format_end = beard::fmt::format_number(0.1 + 0.2, number_buffer);
+  assert(std::string_view(number_buffer, format_end) == "0.30000000000000004");
+  format_end = beard::fmt::format_number(1e-7f, number_buffer);
+  assert(std::string_view(number_buffer, format_end) == "1e-07");
+
   str = "1230981 421809 102983 328190831025 2130598  340912812 098 321098 ";
   auto token_result = beard::fmt::tokenize(str, " ");
   assert(token_result.size() == 8);
   token_result = beard::fmt::tokenize(str, " ", false);
   assert(token_result.size() == 9);
 
+  i32 lazy_token_count = 0;
+  for (auto token : beard::fmt::tokenize_lazy(str, " ")) {
+    assert(!token.empty());
+    ++lazy_token_count;
+  }
+  assert(lazy_token_count == 8);
+  beard::array<std::string_view> reused_tokens;
+  beard::fmt::tokenize(",a,,b,", ",", reused_tokens, false);
+  assert(reused_tokens.element_count() == 4 && reused_tokens[3] == "b");
+  reused_tokens.clear();
+  beard::fmt::tokenize(",a,,b,", ",", reused_tokens);
+  assert(reused_tokens.element_count() == 2 && reused_tokens[0] == "a");
+
+  std::string long_text;
+  for (i32 i = 0; i < 100; ++i) {
+    long_text += std::to_string(i) + (i % 3 == 0 ? ";" : i % 3 == 1 ? "\xe9" : " ");
+  }
+  beard::fmt::delimiter_set delimiters{"; \xe9"};
+  for (usize i = 0; i < long_text.size(); ++i) {
+    assert(delimiters.find_first(long_text, i) ==
+           long_text.find_first_of("; \xe9", i));
+  }
+  assert(beard::fmt::tokenize(long_text, "; \xe9").size() == 100);
+
+  beard::array<std::string_view> lines;
+  beard::fmt::split_lines("first\r\nsecond\n\nlast\n", lines);
+  assert(lines.element_count() == 4 && lines[0] == "first" && lines[2].empty());
+
+  beard::fmt::csv_reader csv;
+  csv.open_from_memory(
+      "id,name,price\r\n1,\"Doe, \"\"J\"\"\",2.5\r\n\r\n2,,\"multi\nline\"");
+  bool has_header = csv.read_header();
+  assert(has_header && csv.column_index("price") == 2);
+  beard::fmt::csv_row csv_row;
+  bool has_row = csv.next_row(csv_row);
+  assert(has_row && csv_row.column_count() == 3);
+  assert(csv_row[1] == "Doe, \"J\"" && csv_row.get<f64>(2).value() == 2.5);
+  has_row = csv.next_row(csv_row);
+  assert(has_row && csv_row[1].empty());
+  assert(csv_row[2] == "multi\nline" && csv_row.line_number() == 4);
+  has_row = csv.next_row(csv_row);
+  assert(!has_row && !csv.has_error());
+
+  beard::thread_pool pool{2};
+  auto records = beard::fmt::split_records("a,\"1\n2\"\nb\nc\n", 4, '"', pool);
+  assert(records.element_count() == 3 && records[0] == "a,\"1\n2\"\n");
+  std::string number_lines;
+  for (i32 i = 0; i < 100000; ++i) {
+    number_lines += std::to_string(i) + "\n";
+  }
+  auto parallel_results = beard::fmt::parse_parallel(
+      number_lines,
+      [](std::string_view chunk) {
+        beard::array<i32> chunk_values;
+        beard::fmt::parse_numbers(chunk, chunk_values);
+        return chunk_values;
+      },
+      '\0', pool);
+  i32 expected_value = 0;
+  for (const auto& chunk_values : parallel_results) {
+    for (i32 value : chunk_values) {
+      assert(value == expected_value++);
+    }
+  }
+  assert(expected_value == 100000);
+
+  // Every worker blocks in an inner loop, whose helpers queue behind them
+  std::atomic<i32> nested_sum = 0;
+  pool.parallel_for(3, [&](i32 i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pool.parallel_for(3, [&](i32 j) { nested_sum += i * 3 + j; });
+  });
+  assert(nested_sum == 36);
+
+  char integer_buffer[beard::fmt::MAX_INTEGER_LENGTH<i64>];
+  auto integer_end = beard::fmt::format_integer(
+      std::numeric_limits<i64>::min(), integer_buffer);
+  assert(std::string_view(integer_buffer, integer_end) ==
+         "-9223372036854775808");
+  integer_end = beard::fmt::format_integer(0u, integer_buffer);
+  assert(std::string_view(integer_buffer, integer_end) == "0");
+  const i32 column[] = {12, -3, 0, 1000};
+  char column_buffer[4 * (beard::fmt::MAX_INTEGER_LENGTH<i32> + 2)];
+  auto column_end =
+      beard::fmt::format_integers<i32>(column, ", ", column_buffer);
+  assert(std::string_view(column_buffer, column_end) == "12, -3, 0, 1000");
+
+  beard::fmt::string_builder builder;
+  builder.append_number(-42);
+  builder.append(',');
+  builder.append_number(0.1);
+  builder.format(",{}:{:>4}", "x", 7);
+  assert(builder.view() == "-42,0.1,x:   7");
+  builder.reset();
+  assert(builder.is_empty() && builder.capacity() > 0);
+
+  beard::fmt::json_document json;
+  bool is_parsed = json.parse(R"({"id": 7, "name": "a \"b\"",
+    "tags": [true, null], "price": -1.5e2,
+    "nested": {"x": [1, [2]], "y": {}}})");
+  assert(is_parsed);
+  auto json_root = json.root();
+  assert(json_root["id"].get_number<i32>().value() == 7);
+  assert(json_root["price"].get_number<f64>().value() == -150.0);
+  assert(json_root["name"].get_raw_string().value() == R"(a \"b\")");
+  std::string json_string;
+  assert(json_root["name"].get_string(json_string) && json_string == "a \"b\"");
+  assert(json_root["tags"].at(0).get_bool().value());
+  assert(json_root["tags"].at(1).is_null());
+  assert(json_root["nested"]["y"].type() == beard::fmt::json_type::object);
+  assert(json_root["nested"]["x"].raw() == "[1, [2]]");
+  assert(!json_root["missing"]["x"].is_valid());
+  i32 json_field_count = 0;
+  for (auto field : json_root.fields()) {
+    json_field_count += field.value.is_valid();
+  }
+  assert(json_field_count == 5);
+  is_parsed = json.parse(R"({"a": "unterminated})");
+  assert(!is_parsed);
+  for (std::string_view blank_text : {"", " \r\n\t "}) {
+    beard::fmt::json_document blank_json;
+    bool is_blank_parsed = blank_json.parse(blank_text);
+    assert(is_blank_parsed && !blank_json.root().is_valid());
+  }
+
+  beard::fmt::ndjson_reader ndjson{"{\"v\": 1}\n{\"v\": 2}\n\n[3]\n", 8};
+  beard::fmt::json_value json_line;
+  i32 json_line_count = 0;
+  while (ndjson.next(json_line)) {
+    ++json_line_count;
+  }
+  assert(json_line_count == 3 && !ndjson.has_error());
+
+  std::string utf8_text = "caf\xc3\xa9 \xe6\x97\xa5 \xf0\x9f\x98\x80";
+  utf8_text += long_text.substr(0, 80);
+  assert(beard::fmt::is_valid_utf8(utf8_text.substr(0, 14)));
+  assert(!beard::fmt::is_valid_utf8(utf8_text.substr(0, 13)));
+  assert(!beard::fmt::is_valid_utf8("\xed\xa0\x80"));
+  assert(!beard::fmt::is_valid_utf8("\xc0\xaf"));
+  assert(beard::fmt::is_valid_utf8(std::string_view{}));
+  auto utf32_text = beard::io::from_utf8("caf\xc3\xa9 \xf0\x9f\x98\x80");
+  assert(utf32_text.has_value() &&
+         utf32_text.value() == U"caf\u00e9 \U0001f600");
+  assert(beard::io::to_utf8(utf32_text.value()).value() ==
+         "caf\xc3\xa9 \xf0\x9f\x98\x80");
+  assert(!beard::io::from_utf8("\xff").has_value());
+
+  beard::io::buffered_file_writer file_writer{16};
+  bool is_writer_open = file_writer.open("test_file_writer.txt");
+  assert(is_writer_open);
+  std::string_view written_pieces[] = {"456", "789"};
+  bool are_pieces_written =
+      file_writer.write("0123") && file_writer.write(written_pieces);
+  assert(are_pieces_written && file_writer.size() == 10);
+  bool is_writer_closed = file_writer.close();
+  assert(is_writer_closed);
+  assert(beard::io::read_whole_file("test_file_writer.txt") == "0123456789");
+  bool is_replaced =
+      beard::io::write_whole_file_atomic("test_file_writer.txt", "new");
+  assert(is_replaced);
+  assert(beard::io::read_whole_file("test_file_writer.txt") == "new");
+  std::remove("test_file_writer.txt");
+
+  bool is_cache_input_written =
+      beard::io::write_whole_file("test_file_cache.txt", "input");
+  assert(is_cache_input_written);
+  {
+    beard::io::file_cache file_cache{"test_file_cache"};
+    bool is_stored = file_cache.store("test_file_cache.txt", "artifact");
+    assert(is_stored);
+    assert(*file_cache.find("test_file_cache.txt") == "artifact");
+    is_cache_input_written =
+        beard::io::write_whole_file("test_file_cache.txt", "other");
+    assert(is_cache_input_written);
+    assert(!file_cache.find("test_file_cache.txt").has_value());
+    auto built = file_cache.find_or_build(
+        "test_file_cache.txt",
+        [](const std::string& content) { return content + " built"; });
+    assert(*built == "other built");
+  }
+  {
+    beard::io::file_cache file_cache{"test_file_cache"};
+    bool is_cache_loaded = file_cache.load();
+    assert(is_cache_loaded && file_cache.entry_count() == 1);
+    assert(*file_cache.find("test_file_cache.txt") == "other built");
+    file_cache.remove("test_file_cache.txt");
+    assert(!file_cache.find("test_file_cache.txt").has_value());
+  }
+  std::filesystem::remove_all("test_file_cache");
+  std::remove("test_file_cache.txt");
+
+  beard::io::pack_builder pack_builder;
+  pack_builder.add("a.txt", "first");
+  pack_builder.add("b/c.txt", "second");
+  pack_builder.add("empty", "");
+  pack_builder.add("a.txt", "replaced");
+  assert(pack_builder.entry_count() == 3);
+  bool is_pack_written = pack_builder.write("test_pack.pack");
+  assert(is_pack_written);
+  {
+    beard::io::pack_file pack;
+    bool is_pack_open = pack.open("test_pack.pack");
+    assert(is_pack_open && pack.entry_count() == 3);
+    assert(*pack.find("a.txt") == "replaced");
+    assert(*pack.find("b/c.txt") == "second");
+    assert(pack.find("empty").value().empty() && !pack.contains("missing"));
+    auto blob = reinterpret_cast<usize>(pack.find("b/c.txt").value().data());
+    assert(blob % beard::io::pack_detail::BLOB_ALIGNMENT == 0);
+    bool is_pack_valid = pack.verify();
+    assert(is_pack_valid);
+    beard::io::pack_file moved_pack = std::move(pack);
+    assert(moved_pack.is_open() && *moved_pack.find("a.txt") == "replaced");
+    assert(!pack.is_open() && pack.entry_count() == 0);
+    assert(!pack.contains("a.txt") && !pack.find("b/c.txt").has_value());
+  }
+  is_pack_written = beard::io::write_whole_file("test_pack.pack", "not a pack");
+  assert(is_pack_written);
+  bool is_invalid_pack_open = beard::io::pack_file{}.open("test_pack.pack");
+  assert(!is_invalid_pack_open);
+  std::remove("test_pack.pack");
+
+  std::filesystem::create_directories("test_scan/a/b");
+  std::filesystem::create_directories("test_scan/.hidden");
+  bool are_scanned_files_written =
+      beard::io::write_whole_file("test_scan/one.png", "1") &&
+      beard::io::write_whole_file("test_scan/a/two.JSON", "22") &&
+      beard::io::write_whole_file("test_scan/a/b/three.png", "333") &&
+      beard::io::write_whole_file("test_scan/.hidden/four.png", "4444");
+  assert(are_scanned_files_written);
+  auto listing = beard::io::scan_directory("test_scan");
+  listing.sort();
+  assert(listing.entry_count() == 4 && listing.error_count() == 0);
+  assert(listing[0].path == "test_scan/.hidden/four.png");
+  assert(listing[1].path == "test_scan/a/b/three.png" && listing[1].size == 3);
+  assert(listing[1].name() == "three.png" && listing[1].extension() == "png");
+  beard::io::scan_options scan_options;
+  scan_options.extensions = {".json", "png"};
+  scan_options.pattern = "t*e?*";
+  scan_options.skip_hidden = true;
+  listing = beard::io::scan_directory("test_scan", scan_options);
+  assert(listing.entry_count() == 1 && listing[0].name() == "three.png");
+  assert(beard::io::match_pattern("two.JSON", "*.JSON"));
+  assert(!beard::io::match_pattern("two.JSON", "*.json"));
+  assert(beard::io::scan_directory("missing_dir").error_count() == 1);
+  std::filesystem::remove_all("test_scan");
+
+  std::string compressible;
+  for (i32 i = 0; i < 10000; ++i) {
+    compressible +=
+        std::to_string(i % 100) + ",name_" + std::to_string(i) + "\n";
+  }
+  for (auto level : {beard::io::compression_level::fast,
+                     beard::io::compression_level::high}) {
+    std::string frame = beard::io::compress(compressible, level, 4096);
+    assert(frame.size() < compressible.size() / 2);
+    assert(*beard::io::decompress(frame) == compressible);
+    frame.resize(frame.size() - 3);
+    assert(!beard::io::decompress(frame).has_value());
+  }
+  std::string block(beard::io::compress_bound(compressible.size()), '\0');
+  block.resize(beard::io::compress_block(compressible, block));
+  std::string too_small(compressible.size() - 1, '\0');
+  assert(!beard::io::decompress_block(block, too_small).has_value());
+  assert(!beard::io::decompress("BRLZ").has_value());
+  {
+    beard::io::compressed_file_writer compressed_writer{
+        beard::io::compression_level::fast, 1000};
+    bool is_compressed_written =
+        compressed_writer.open("test_compressed.lz") &&
+        compressed_writer.write(compressible.substr(0, 1500)) &&
+        compressed_writer.write(compressible.substr(1500)) &&
+        compressed_writer.close();
+    assert(is_compressed_written);
+    assert(compressed_writer.size() == compressible.size());
+
+    beard::io::compressed_file_reader compressed_reader{100};
+    bool is_compressed_open = compressed_reader.open("test_compressed.lz");
+    assert(is_compressed_open);
+    std::string decompressed;
+    usize line_tail = 0;
+    for (auto chunk = compressed_reader.next_chunk(); !chunk.empty();
+         chunk = compressed_reader.next_chunk(line_tail)) {
+      // Carry partial lines over, the last chunk always ends with a newline
+      std::string_view text{chunk.data(), chunk.size()};
+      usize whole_size = text.find_last_of('\n') + 1;
+      decompressed.append(text.substr(0, whole_size));
+      line_tail = text.size() - whole_size;
+    }
+    assert(!compressed_reader.has_error() && decompressed == compressible);
+  }
+  std::remove("test_compressed.lz");
+
+  static_assert(beard::io::zigzag_encode(i32{-1}) == 1 &&
+                beard::io::zigzag_encode(i64{2}) == 4 &&
+                beard::io::zigzag_decode(u64{3}) == -2);
+  beard::array<u32> integers;
+  for (u32 i = 0; i < 1000; ++i) {
+    integers.add(i * i % 300 + (i % 100 == 0 ? 100000 : 0));
+  }
+  std::span<const u32> integer_span{integers.data(), 1000};
+  std::string varints;
+  beard::io::encode_varints(integer_span, varints);
+  assert(varints.size() < 2100);
+  beard::array<u32> decoded_integers;
+  bool is_decoded = beard::io::decode_varints(varints, decoded_integers);
+  assert(is_decoded && decoded_integers.element_count() == 1000 &&
+         std::equal(integers.begin(), integers.end(),
+                    decoded_integers.begin()));
+  is_decoded = beard::io::decode_varints("\x80", decoded_integers) ||
+               beard::io::decode_varints("\xff\xff\xff\xff\x10",
+                                         decoded_integers);
+  assert(!is_decoded);
+  std::string_view varint_input = "\xac\x02!";
+  auto varint = beard::io::read_varint(varint_input);
+  assert(*varint == 300 && varint_input == "!");
+
+  for (auto packing :
+       {beard::io::bit_packing::mode::plain,
+        beard::io::bit_packing::mode::delta}) {
+    std::string packed;
+    beard::io::pack_integers(integer_span, packed, packing);
+    bool is_unpacked = beard::io::unpack_integers(packed, decoded_integers);
+    assert(is_unpacked && decoded_integers.element_count() == 1000 &&
+           std::equal(integers.begin(), integers.end(),
+                      decoded_integers.begin()));
+    // The mode byte follows the 2 bytes varint of the count
+    std::string bad_mode = packed;
+    bad_mode[2] = static_cast<char>(bad_mode[2] | 0x80);
+    is_unpacked = beard::io::unpack_integers(bad_mode, decoded_integers);
+    assert(!is_unpacked);
+    packed.pop_back();
+    is_unpacked = beard::io::unpack_integers(packed, decoded_integers);
+    assert(!is_unpacked);
+  }
+  std::string sorted_packed;
+  beard::array<u32> sorted_integers;
+  for (u32 i = 0; i < 1000; ++i) {
+    sorted_integers.add(1000000 + i * 3);
+  }
+  beard::io::pack_integers({sorted_integers.data(), 1000}, sorted_packed,
+                           beard::io::bit_packing::mode::delta);
+  // 2 bits per value and the block headers
+  assert(sorted_packed.size() < 300);
+  beard::io::delta_encode(std::span<u32>{sorted_integers.data(), 1000});
+  assert(sorted_integers[0] == 1000000 && sorted_integers[999] == 3);
+  beard::io::delta_decode(std::span<u32>{sorted_integers.data(), 1000});
+  assert(sorted_integers[999] == 1000000 + 999 * 3);
+
+  beard::hash_map<std::string, beard::array<u32>> serialized_map;
+  serialized_map.add("first", {1, 2, 3});
+  serialized_map.add("empty", {});
+  beard::string_hash_set serialized_set{"a", "bc"};
+  beard::optional<std::string> serialized_optional = std::string("value");
+  std::string serialized;
+  {
+    beard::io::binary_writer writer{serialized};
+    bool is_written = writer.write_header(3) && writer.write(serialized_map) &&
+                      writer.write(serialized_set) &&
+                      writer.write(serialized_optional) &&
+                      writer.write(sorted_integers);
+    assert(is_written);
+  }
+  {
+    beard::io::binary_reader reader{serialized};
+    beard::hash_map<std::string, beard::array<u32>> loaded_map;
+    beard::string_hash_set loaded_set;
+    beard::optional<std::string> loaded_optional;
+    beard::array<u32> loaded_integers;
+    auto version = reader.read_header();
+    assert(*version == 3 && reader.version() == 3);
+    bool is_read = reader.read(loaded_map) && reader.read(loaded_set) &&
+                   reader.read(loaded_optional) && reader.read(loaded_integers);
+    assert(is_read && reader.remaining() == 0 && !reader.has_error());
+    assert(loaded_map.element_count() == 2 && loaded_map["first"][2] == 3 &&
+           loaded_map["empty"].is_empty());
+    assert(loaded_set.contains("bc") && *loaded_optional == "value");
+    assert(loaded_integers.element_count() == 1000 &&
+           loaded_integers[999] == sorted_integers[999]);
+  }
+  {
+    beard::io::binary_writer writer;
+    bool is_written = writer.open("test_serialization.bin") &&
+                      writer.write_header(1) && writer.write(sorted_integers);
+    bool is_closed = writer.close();
+    assert(is_written && is_closed);
+
+    beard::io::binary_reader reader;
+    beard::array<u32> loaded_integers;
+    bool is_read = reader.open("test_serialization.bin") &&
+                   reader.read_header().has_value() &&
+                   reader.read(loaded_integers);
+    assert(is_read && std::equal(loaded_integers.begin(), loaded_integers.end(),
+                                 sorted_integers.begin()));
+    is_read = reader.read(loaded_integers);
+    assert(!is_read && reader.has_error());
+  }
+  std::remove("test_serialization.bin");
+  {
+    beard::string_hash_map<i32> string_map{{"one", 1}, {"two", 2}};
+    std::string string_map_bytes;
+    beard::io::binary_writer writer{string_map_bytes};
+    bool is_written = writer.write(string_map);
+    assert(is_written);
+
+    beard::io::binary_reader reader{string_map_bytes};
+    beard::string_hash_map<i32> loaded_string_map;
+    bool is_read = reader.read(loaded_string_map);
+    assert(is_read && loaded_string_map.element_count() == 2 &&
+           loaded_string_map["two"] == 2);
+  }
+  {
+    beard::io::binary_reader reader{
+        std::string_view{serialized}.substr(0, serialized.size() - 1)};
+    beard::hash_map<std::string, beard::array<u32>> loaded_map;
+    beard::string_hash_set loaded_set;
+    beard::optional<std::string> loaded_optional;
+    beard::array<u32> loaded_integers;
+    bool is_read = reader.read_header().has_value() &&
+                   reader.read(loaded_map) && reader.read(loaded_set) &&
+                   reader.read(loaded_optional);
+    assert(is_read);
+    is_read = reader.read(loaded_integers);
+    assert(!is_read && reader.has_error());
+    assert(!beard::io::binary_reader{"not a stream"}.read_header().has_value());
+  }
+
+  bool is_async_input_written =
+      beard::io::write_whole_file("test_async_read.txt", "0123456789");
+  assert(is_async_input_written);
+  beard::io::async_reader async_reader;
+  char async_buffer[16];
+  auto async_read = async_reader.read("test_async_read.txt", async_buffer, 4);
+  auto async_result = async_read.get();
+  assert(async_result.ok() && async_result.size == 6 &&
+         std::string_view(async_buffer, 6) == "456789");
+  i32 async_error = 0;
+  async_reader.read("missing_file.txt", async_buffer,
+                    [&](const beard::io::read_result& result) {
+                      async_error = result.error;
+                    });
+  async_reader.wait();
+  assert(async_error != 0);
+  std::string_view batch_paths[] = {"test_async_read.txt", "missing_file.txt"};
+  auto file_batch = beard::io::read_many_files(batch_paths, async_reader);
+  assert(file_batch.file_count() == 2 && file_batch[0] == "0123456789");
+  assert(file_batch.error(0) == 0 && file_batch.error(1) != 0);
+  beard::io::file_stream_reader stream_reader{3, 2};
+  bool is_stream_open = stream_reader.open("test_async_read.txt");
+  assert(is_stream_open);
+  std::string streamed;
+  usize carry_over = 0;
+  for (auto chunk = stream_reader.next_chunk(); !chunk.empty();
+       chunk = stream_reader.next_chunk(carry_over)) {
+    // Leave odd tails for the next chunk, as a parser would partial records
+    usize whole_size = chunk.size() & ~usize{1};
+    streamed.append(chunk.data(), whole_size);
+    carry_over = chunk.size() - whole_size;
+  }
+  assert(streamed == "0123456789" && !stream_reader.has_error());
+  stream_reader.close();
+  std::remove("test_async_read.txt");
+
+  assert(beard::hash64::hash("Hello !") == beard::hash64::hash("Hello !"));
+  assert(beard::hash64::hash("Hello !") != beard::hash64::hash("Hello ?"));
+
+  beard::string_hash_map<i32> to_freeze = {{"one", 1}, {"two", 2}, {"", 3}};
+  auto frozen_bytes = beard::frozen_string_hash_map<i32>::serialize(to_freeze);
+  beard::frozen_string_hash_map<i32> frozen;
+  bool is_frozen_loaded = frozen.load_from_memory(frozen_bytes);
+  assert(is_frozen_loaded && frozen.element_count() == 3);
+  assert(frozen.contains("two") && !frozen.contains("three"));
+  assert(frozen.get_value_or("", 0) == 3);
+  assert(frozen.find("one")->second == 1);
+  i32 frozen_sum = 0;
+  for (auto [key, value] : frozen) {
+    frozen_sum += value;
+  }
+  assert(frozen_sum == 6);
+  beard::frozen_string_hash_map<i32> moved_frozen = std::move(frozen);
+  assert(moved_frozen.get_value_or("two", 0) == 2);
+  assert(frozen.is_empty() && frozen.begin() == frozen.end());
+  assert(!frozen.contains("two"));
+  // Strings running past their section, or no empty slot to end probing
+  using frozen_slot = beard::frozen_detail::slot<std::string, i32>;
+  beard::frozen_detail::header frozen_header;
+  memcpy(&frozen_header, frozen_bytes.data(), sizeof(frozen_header));
+  for (i32 corruption = 0; corruption < 2; ++corruption) {
+    std::string corrupted_bytes = frozen_bytes;
+    auto corrupted_slots = reinterpret_cast<frozen_slot*>(
+        corrupted_bytes.data() + frozen_header.slots_offset);
+    for (u64 i = 0; i < frozen_header.slot_count; ++i) {
+      if (corruption == 0) {
+        corrupted_slots[i].key.length = MB(u64{1});
+      } else {
+        corrupted_slots[i].hash |= 1;
+      }
+    }
+    beard::frozen_string_hash_map<i32> corrupted;
+    bool is_corrupted_loaded = corrupted.load_from_memory(corrupted_bytes);
+    assert(!is_corrupted_loaded && corrupted.is_empty());
+  }
+
+  beard::string_interner interner;
+  auto hello_id = interner.intern("hello");
+  auto world_id = interner.intern("world");
+  auto built_hello_id = interner.intern(std::string{"hel"} + "lo");
+  assert(world_id != hello_id && built_hello_id == hello_id);
+  assert(interner.get(hello_id) == "hello");
+  assert(!interner.find("nope").has_value());
+
+  beard::array<std::thread> interning_threads;
+  for (i32 t = 0; t < 4; ++t) {
+    interning_threads.add(std::thread{[&interner] {
+      for (i32 i = 0; i < 5000; ++i) {
+        auto id = interner.intern(std::to_string(i));
+        assert(interner.get(id) == std::to_string(i));
+      }
+    }});
+  }
+  for (auto& t : interning_threads) {
+    t.join();
+  }
+  assert(interner.element_count() == 5002);
+
+  beard::bloom_filter bloom{10000, 0.01};
+  for (i32 i = 0; i < 10000; ++i) {
+    bloom.add(std::to_string(i));
+  }
+  i32 false_positives = 0;
+  for (i32 i = 0; i < 10000; ++i) {
+    assert(bloom.contains(std::to_string(i)));
+    false_positives += bloom.contains(std::to_string(-i - 1));
+  }
+  assert(false_positives < 200);
+
+  beard::bloom_filter other_bloom{10000, 0.01};
+  std::string_view bulk_keys[] = {"a", "b", "c"};
+  other_bloom.add_all(bulk_keys);
+  bool is_bloom_merged = bloom.merge(other_bloom);
+  assert(is_bloom_merged && bloom.contains("b"));
+  beard::bloom_filter loaded_bloom;
+  bool is_bloom_loaded = loaded_bloom.deserialize(bloom.serialize());
+  assert(is_bloom_loaded);
+  beard::array<u8> bloom_results;
+  loaded_bloom.contains_all(bulk_keys, bloom_results);
+  assert(bloom_results.element_count() == 3 && bloom_results[2] == 1);
+
+  beard::cuckoo_filter cuckoo{10000, 0.01};
+  for (i32 i = 0; i < 10000; ++i) {
+    bool is_added = cuckoo.add(std::to_string(i));
+    assert(is_added);
+  }
+  assert(cuckoo.element_count() == 10000);
+  for (i32 i = 0; i < 10000; i += 2) {
+    bool is_removed = cuckoo.remove(std::to_string(i));
+    assert(is_removed);
+  }
+  false_positives = 0;
+  for (i32 i = 1; i < 10000; i += 2) {
+    assert(cuckoo.contains(std::to_string(i)));
+    false_positives += cuckoo.contains(std::to_string(i - 1));
+  }
+  assert(false_positives < 100);
+  std::string_view cuckoo_keys[] = {"x", "y", "z"};
+  i32 cuckoo_added = cuckoo.add_all(cuckoo_keys);
+  i32 cuckoo_removed = cuckoo.remove_all({cuckoo_keys, 2});
+  beard::array<u8> cuckoo_results;
+  cuckoo.contains_all(cuckoo_keys, cuckoo_results);
+  assert(cuckoo_added == 3 && cuckoo_removed == 2 && cuckoo_results[2] == 1);
+  assert(cuckoo.element_count() == 5001);
+
+  beard::hyperloglog distinct_low;
+  beard::hyperloglog distinct_high;
+  for (i32 i = 0; i < 200000; ++i) {
+    distinct_low.add(std::to_string(i % 1000));
+    distinct_high.add(std::to_string(i));
+  }
+  assert(distinct_low.is_sparse() && !distinct_high.is_sparse());
+  assert(std::abs(distinct_low.estimate() - 1000.0) < 10.0);
+  assert(std::abs(distinct_high.estimate() - 200000.0) < 200000.0 * 0.03);
+  bool is_merged = distinct_low.merge(distinct_high);
+  assert(is_merged);
+  assert(std::abs(distinct_low.estimate() - 200000.0) < 200000.0 * 0.03);
+
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,49 @@
+#include <beard/io/pack.h>
+#include <fmt/core.h>
+
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Usage: BeardPack <output> <input>...
+// Packs the given files, and the files found under the given directories
+// under their path relative to that directory
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fmt::print(stderr, "Usage: {} <output> <input>...\n", argv[0]);
+    return 1;
+  }
+
+  beard::io::pack_builder builder;
+  for (int i = 2; i < argc; ++i) {
+    fs::path input{argv[i]};
+    std::error_code error;
+    if (fs::is_directory(input, error)) {
+      for (fs::recursive_directory_iterator it{input, error}, end;
+           !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error)) {
+          fs::path path = it->path().lexically_relative(input);
+          builder.add_file(path.generic_string(), it->path().string());
+        }
+      }
+    } else if (fs::is_regular_file(input, error)) {
+      builder.add_file(input.filename().generic_string(), input.string());
+    } else {
+      error = std::make_error_code(std::errc::no_such_file_or_directory);
+    }
+
+    if (error) {
+      fmt::print(stderr, "{}: {}\n", argv[i], error.message());
+      return 1;
+    }
+  }
+
+  if (!builder.write(argv[1])) {
+    fmt::print(stderr, "Could not write {}\n", argv[1]);
+    return 1;
+  }
+
+  fmt::print("Packed {} files in {}\n", builder.entry_count(), argv[1]);
+  return 0;
+}